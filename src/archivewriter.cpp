@@ -0,0 +1,447 @@
+/***************************************************************************
+
+	archivewriter.cpp
+
+	Streams extracted files straight into ZIP or tar archives
+
+***************************************************************************/
+
+// qfloptool headers
+#include "archivewriter.h"
+
+// Qt headers
+#include <QIODevice>
+#include <QtEndian>
+
+// C++ headers
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// zlib
+#include <zlib.h>
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+// ZIP signatures and limits; without ZIP64 records, offsets, sizes and entry counts have
+// to fit in the classic fields, which is plenty for anything that fits on a disk image
+static const uint32_t s_zipLocalHeaderSignature = 0x04034B50;
+static const uint32_t s_zipCentralHeaderSignature = 0x02014B50;
+static const uint32_t s_zipEndOfCentralDirectorySignature = 0x06054B50;
+static const uint16_t s_zipVersion = 20;
+static const uint16_t s_zipUtf8Flag = 0x0800;
+static const uint16_t s_zipMethodStored = 0;
+static const uint16_t s_zipMethodDeflated = 8;
+static const uint32_t s_zipDirectoryAttributes = 0x10;
+static const uint64_t s_zipMaximumOffset = 0xFFFFFFFF;
+static const std::size_t s_zipMaximumEntryCount = 0xFFFF;
+
+// tar blocks, and the ustar header layout
+static const std::size_t s_tarBlockSize = 512;
+static const std::size_t s_tarNameLength = 100;
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+namespace
+{
+	// ======================> ZipWriter
+
+	class ZipWriter : public ArchiveWriter
+	{
+	public:
+		using ArchiveWriter::ArchiveWriter;
+
+		virtual bool addDirectory(const QString &path, const std::optional<QDateTime> &modified) override;
+		virtual bool addFile(const QString &path, const std::vector<uint8_t> &bytes, const std::optional<QDateTime> &modified) override;
+		virtual bool finish() override;
+
+	private:
+		struct Entry
+		{
+			QByteArray	m_name;
+			uint16_t	m_method;
+			uint16_t	m_time;
+			uint16_t	m_date;
+			uint32_t	m_crc;
+			uint32_t	m_compressedSize;
+			uint32_t	m_size;
+			uint32_t	m_externalAttributes;
+			uint32_t	m_offset;
+		};
+
+		std::vector<Entry>	m_entries;
+		uint64_t			m_offset = 0;
+
+		bool addEntry(Entry &&entry, const uint8_t *data);
+	};
+
+
+	// ======================> TarWriter
+
+	class TarWriter : public ArchiveWriter
+	{
+	public:
+		using ArchiveWriter::ArchiveWriter;
+
+		virtual bool addDirectory(const QString &path, const std::optional<QDateTime> &modified) override;
+		virtual bool addFile(const QString &path, const std::vector<uint8_t> &bytes, const std::optional<QDateTime> &modified) override;
+		virtual bool finish() override;
+
+	private:
+		bool writeHeader(const QByteArray &name, char type, uint64_t size, qint64 modified);
+		bool writeData(const uint8_t *data, std::size_t length);
+	};
+}
+
+
+//**************************************************************************
+//  ARCHIVE WRITER IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+ArchiveWriter::ArchiveWriter(QIODevice &device)
+	: m_device(device)
+{
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+ArchiveWriter::~ArchiveWriter()
+{
+}
+
+
+//-------------------------------------------------
+//  createZip
+//-------------------------------------------------
+
+ArchiveWriter::ptr ArchiveWriter::createZip(QIODevice &device)
+{
+	return std::make_unique<ZipWriter>(device);
+}
+
+
+//-------------------------------------------------
+//  createTar
+//-------------------------------------------------
+
+ArchiveWriter::ptr ArchiveWriter::createTar(QIODevice &device)
+{
+	return std::make_unique<TarWriter>(device);
+}
+
+
+//-------------------------------------------------
+//  write
+//-------------------------------------------------
+
+bool ArchiveWriter::write(const QByteArray &bytes)
+{
+	return m_device.write(bytes) == bytes.size();
+}
+
+
+//-------------------------------------------------
+//  write
+//-------------------------------------------------
+
+bool ArchiveWriter::write(const uint8_t *bytes, std::size_t length)
+{
+	return length == 0 || m_device.write((const char *)bytes, (qint64)length) == (qint64)length;
+}
+
+
+//**************************************************************************
+//  ZIP WRITER IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  appendLittleEndian
+//-------------------------------------------------
+
+template<typename T>
+static void appendLittleEndian(QByteArray &bytes, T value)
+{
+	T littleEndianValue = qToLittleEndian(value);
+	bytes.append((const char *)&littleEndianValue, sizeof(littleEndianValue));
+}
+
+
+//-------------------------------------------------
+//  dosDateTime
+//-------------------------------------------------
+
+static std::pair<uint16_t, uint16_t> dosDateTime(const std::optional<QDateTime> &modified)
+{
+	// ZIP headers carry MS-DOS dates and times, which only cover 1980 through 2107 in
+	// two second steps
+	QDateTime dateTime = modified && modified->isValid() ? *modified : QDateTime::currentDateTime();
+	QDate date = dateTime.date();
+	QTime time = dateTime.time();
+	int year = std::clamp(date.year(), 1980, 2107);
+
+	uint16_t dosDate = (uint16_t)(((year - 1980) << 9) | (date.month() << 5) | date.day());
+	uint16_t dosTime = (uint16_t)((time.hour() << 11) | (time.minute() << 5) | (time.second() / 2));
+	return { dosDate, dosTime };
+}
+
+
+//-------------------------------------------------
+//  addDirectory
+//-------------------------------------------------
+
+bool ZipWriter::addDirectory(const QString &path, const std::optional<QDateTime> &modified)
+{
+	auto [date, time] = dosDateTime(modified);
+
+	Entry entry;
+	entry.m_name = (path + '/').toUtf8();
+	entry.m_method = s_zipMethodStored;
+	entry.m_time = time;
+	entry.m_date = date;
+	entry.m_crc = 0;
+	entry.m_compressedSize = 0;
+	entry.m_size = 0;
+	entry.m_externalAttributes = s_zipDirectoryAttributes;
+	return addEntry(std::move(entry), nullptr);
+}
+
+
+//-------------------------------------------------
+//  addFile
+//-------------------------------------------------
+
+bool ZipWriter::addFile(const QString &path, const std::vector<uint8_t> &bytes, const std::optional<QDateTime> &modified)
+{
+	if (bytes.size() > s_zipMaximumOffset)
+		return false;
+
+	// the whole file is in hand, so the CRC and sizes can go in the local header itself
+	// rather than in a data descriptor after the data
+	uint32_t crc = crc32(0L, bytes.data(), (uInt)bytes.size());
+
+	// deflate in one go; the output buffer is sized so that this always finishes
+	std::vector<uint8_t> compressed;
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+	if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+	compressed.resize(deflateBound(&stream, (uLong)bytes.size()));
+	stream.next_in = (Bytef *)bytes.data();
+	stream.avail_in = (uInt)bytes.size();
+	stream.next_out = compressed.data();
+	stream.avail_out = (uInt)compressed.size();
+	int err = deflate(&stream, Z_FINISH);
+	compressed.resize(stream.total_out);
+	deflateEnd(&stream);
+	if (err != Z_STREAM_END)
+		return false;
+
+	// files that do not shrink (often the case for anything already packed) are stored
+	bool isDeflated = compressed.size() < bytes.size();
+	auto [date, time] = dosDateTime(modified);
+
+	Entry entry;
+	entry.m_name = path.toUtf8();
+	entry.m_method = isDeflated ? s_zipMethodDeflated : s_zipMethodStored;
+	entry.m_time = time;
+	entry.m_date = date;
+	entry.m_crc = crc;
+	entry.m_compressedSize = (uint32_t)(isDeflated ? compressed.size() : bytes.size());
+	entry.m_size = (uint32_t)bytes.size();
+	entry.m_externalAttributes = 0;
+	return addEntry(std::move(entry), isDeflated ? compressed.data() : bytes.data());
+}
+
+
+//-------------------------------------------------
+//  addEntry
+//-------------------------------------------------
+
+bool ZipWriter::addEntry(Entry &&entry, const uint8_t *data)
+{
+	// the local header and data go out now; the entry is remembered for the central
+	// directory at the end
+	uint64_t entryLength = 30 + entry.m_name.size() + entry.m_compressedSize;
+	if (m_entries.size() >= s_zipMaximumEntryCount || m_offset + entryLength > s_zipMaximumOffset)
+		return false;
+	entry.m_offset = (uint32_t)m_offset;
+
+	QByteArray header;
+	appendLittleEndian<uint32_t>(header, s_zipLocalHeaderSignature);
+	appendLittleEndian<uint16_t>(header, s_zipVersion);
+	appendLittleEndian<uint16_t>(header, s_zipUtf8Flag);
+	appendLittleEndian<uint16_t>(header, entry.m_method);
+	appendLittleEndian<uint16_t>(header, entry.m_time);
+	appendLittleEndian<uint16_t>(header, entry.m_date);
+	appendLittleEndian<uint32_t>(header, entry.m_crc);
+	appendLittleEndian<uint32_t>(header, entry.m_compressedSize);
+	appendLittleEndian<uint32_t>(header, entry.m_size);
+	appendLittleEndian<uint16_t>(header, (uint16_t)entry.m_name.size());
+	appendLittleEndian<uint16_t>(header, 0);
+	header.append(entry.m_name);
+
+	if (!write(header) || !write(data, entry.m_compressedSize))
+		return false;
+	m_offset += entryLength;
+	m_entries.push_back(std::move(entry));
+	return true;
+}
+
+
+//-------------------------------------------------
+//  finish
+//-------------------------------------------------
+
+bool ZipWriter::finish()
+{
+	QByteArray centralDirectory;
+	for (const Entry &entry : m_entries)
+	{
+		appendLittleEndian<uint32_t>(centralDirectory, s_zipCentralHeaderSignature);
+		appendLittleEndian<uint16_t>(centralDirectory, s_zipVersion);
+		appendLittleEndian<uint16_t>(centralDirectory, s_zipVersion);
+		appendLittleEndian<uint16_t>(centralDirectory, s_zipUtf8Flag);
+		appendLittleEndian<uint16_t>(centralDirectory, entry.m_method);
+		appendLittleEndian<uint16_t>(centralDirectory, entry.m_time);
+		appendLittleEndian<uint16_t>(centralDirectory, entry.m_date);
+		appendLittleEndian<uint32_t>(centralDirectory, entry.m_crc);
+		appendLittleEndian<uint32_t>(centralDirectory, entry.m_compressedSize);
+		appendLittleEndian<uint32_t>(centralDirectory, entry.m_size);
+		appendLittleEndian<uint16_t>(centralDirectory, (uint16_t)entry.m_name.size());
+		appendLittleEndian<uint16_t>(centralDirectory, 0);
+		appendLittleEndian<uint16_t>(centralDirectory, 0);
+		appendLittleEndian<uint16_t>(centralDirectory, 0);
+		appendLittleEndian<uint16_t>(centralDirectory, 0);
+		appendLittleEndian<uint32_t>(centralDirectory, entry.m_externalAttributes);
+		appendLittleEndian<uint32_t>(centralDirectory, entry.m_offset);
+		centralDirectory.append(entry.m_name);
+	}
+	if (m_offset + centralDirectory.size() > s_zipMaximumOffset)
+		return false;
+
+	QByteArray end;
+	appendLittleEndian<uint32_t>(end, s_zipEndOfCentralDirectorySignature);
+	appendLittleEndian<uint16_t>(end, 0);
+	appendLittleEndian<uint16_t>(end, 0);
+	appendLittleEndian<uint16_t>(end, (uint16_t)m_entries.size());
+	appendLittleEndian<uint16_t>(end, (uint16_t)m_entries.size());
+	appendLittleEndian<uint32_t>(end, (uint32_t)centralDirectory.size());
+	appendLittleEndian<uint32_t>(end, (uint32_t)m_offset);
+	appendLittleEndian<uint16_t>(end, 0);
+
+	return write(centralDirectory) && write(end);
+}
+
+
+//**************************************************************************
+//  TAR WRITER IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  unixTime
+//-------------------------------------------------
+
+static qint64 unixTime(const std::optional<QDateTime> &modified)
+{
+	return std::max(modified && modified->isValid()
+		? modified->toSecsSinceEpoch()
+		: QDateTime::currentSecsSinceEpoch(), (qint64)0);
+}
+
+
+//-------------------------------------------------
+//  addDirectory
+//-------------------------------------------------
+
+bool TarWriter::addDirectory(const QString &path, const std::optional<QDateTime> &modified)
+{
+	return writeHeader((path + '/').toUtf8(), '5', 0, unixTime(modified));
+}
+
+
+//-------------------------------------------------
+//  addFile
+//-------------------------------------------------
+
+bool TarWriter::addFile(const QString &path, const std::vector<uint8_t> &bytes, const std::optional<QDateTime> &modified)
+{
+	return writeHeader(path.toUtf8(), '0', bytes.size(), unixTime(modified))
+		&& writeData(bytes.data(), bytes.size());
+}
+
+
+//-------------------------------------------------
+//  writeHeader
+//-------------------------------------------------
+
+bool TarWriter::writeHeader(const QByteArray &name, char type, uint64_t size, qint64 modified)
+{
+	// names that do not fit in the header go in a GNU long name record ahead of it, which
+	// every tar reader of note understands
+	if ((std::size_t)name.size() > s_tarNameLength)
+	{
+		QByteArray longName = name + '\0';
+		if (!writeHeader("././@LongLink", 'L', longName.size(), 0)
+			|| !writeData((const uint8_t *)longName.constData(), longName.size()))
+			return false;
+	}
+
+	char header[s_tarBlockSize];
+	memset(header, 0, sizeof(header));
+	memcpy(&header[0], name.constData(), std::min((std::size_t)name.size(), s_tarNameLength));
+	snprintf(&header[100], 8, "%07o", type == '5' ? 0755 : 0644);
+	snprintf(&header[108], 8, "%07o", 0);
+	snprintf(&header[116], 8, "%07o", 0);
+	snprintf(&header[124], 12, "%011llo", (unsigned long long)size);
+	snprintf(&header[136], 12, "%011llo", (unsigned long long)modified);
+	header[156] = type;
+	memcpy(&header[257], "ustar", 6);
+	memcpy(&header[263], "00", 2);
+
+	// the checksum is taken with its own field filled with spaces
+	memset(&header[148], ' ', 8);
+	unsigned int checksum = 0;
+	for (char c : header)
+		checksum += (uint8_t)c;
+	snprintf(&header[148], 8, "%06o", checksum);
+
+	return write((const uint8_t *)header, sizeof(header));
+}
+
+
+//-------------------------------------------------
+//  writeData
+//-------------------------------------------------
+
+bool TarWriter::writeData(const uint8_t *data, std::size_t length)
+{
+	// data is padded out to a whole number of blocks
+	static const uint8_t s_padding[s_tarBlockSize] = { 0 };
+	std::size_t paddingLength = (s_tarBlockSize - length % s_tarBlockSize) % s_tarBlockSize;
+	return write(data, length) && write(s_padding, paddingLength);
+}
+
+
+//-------------------------------------------------
+//  finish
+//-------------------------------------------------
+
+bool TarWriter::finish()
+{
+	// the end of the archive is marked by two empty blocks
+	static const uint8_t s_endOfArchive[s_tarBlockSize * 2] = { 0 };
+	return write(s_endOfArchive, sizeof(s_endOfArchive));
+}
@@ -0,0 +1,62 @@
+/***************************************************************************
+
+	archivewriter.h
+
+	Streams extracted files straight into ZIP or tar archives
+
+***************************************************************************/
+
+#ifndef ARCHIVEWRITER_H
+#define ARCHIVEWRITER_H
+
+// Qt headers
+#include <QDateTime>
+#include <QString>
+
+// C++ headers
+#include <memory>
+#include <optional>
+#include <vector>
+
+
+QT_BEGIN_NAMESPACE
+class QIODevice;
+QT_END_NAMESPACE
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> ArchiveWriter
+
+class ArchiveWriter
+{
+public:
+	typedef std::unique_ptr<ArchiveWriter> ptr;
+
+	// ctor/dtor
+	ArchiveWriter(QIODevice &device);
+	ArchiveWriter(const ArchiveWriter &) = delete;
+	ArchiveWriter(ArchiveWriter &&) = delete;
+	virtual ~ArchiveWriter();
+
+	// statics
+	static ptr createZip(QIODevice &device);
+	static ptr createTar(QIODevice &device);
+
+	// entries have to be added in order, with directories before their contents; paths
+	// are relative and separated by '/'
+	virtual bool addDirectory(const QString &path, const std::optional<QDateTime> &modified) = 0;
+	virtual bool addFile(const QString &path, const std::vector<uint8_t> &bytes, const std::optional<QDateTime> &modified) = 0;
+	virtual bool finish() = 0;
+
+protected:
+	QIODevice &		m_device;
+
+	bool write(const QByteArray &bytes);
+	bool write(const uint8_t *bytes, std::size_t length);
+};
+
+
+#endif // ARCHIVEWRITER_H
@@ -0,0 +1,663 @@
+/***************************************************************************
+
+	cliengine.cpp
+
+	Headless command line front end
+
+***************************************************************************/
+
+// qfloptool headers
+#include "cliengine.h"
+#include "extractor.h"
+#include "identifycache.h"
+
+// MAME headers
+#include "formats/fsmgr.h"
+
+// Qt headers
+#include <QCommandLineParser>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSemaphore>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+
+// C++ headers
+#include <algorithm>
+#include <mutex>
+#include <optional>
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+CliEngine::CliEngine(QTextStream &out, QTextStream &err)
+	: m_out(out)
+	, m_err(err)
+{
+}
+
+
+//-------------------------------------------------
+//  run
+//-------------------------------------------------
+
+int CliEngine::run(const QStringList &arguments)
+{
+	// the first positional argument is the command; we parse leniently since the
+	// command specific options are not known yet
+	QCommandLineParser parser;
+	parser.addPositionalArgument("command", "identify, ls, extract or scan");
+	parser.parse(arguments);
+	QStringList positionalArguments = parser.positionalArguments();
+	if (positionalArguments.isEmpty())
+	{
+		usage();
+		return 1;
+	}
+	QString command = positionalArguments.first();
+	parser.clearPositionalArguments();
+
+	int result;
+	if (command == "identify")
+		result = identify(parser, arguments);
+	else if (command == "ls")
+		result = list(parser, arguments);
+	else if (command == "extract")
+		result = extract(parser, arguments);
+	else if (command == "scan")
+		result = scan(parser, arguments);
+	else
+	{
+		m_err << "Unknown command: " << command << Qt::endl;
+		usage();
+		result = 1;
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  usage
+//-------------------------------------------------
+
+void CliEngine::usage()
+{
+	m_err << "Usage:" << Qt::endl;
+	m_err << "  qfloptool-cli identify [--exhaustive] <image>" << Qt::endl;
+	m_err << "  qfloptool-cli ls [--format <fmt>] [--filesystem <fs>] [--recursive] <image> [path]" << Qt::endl;
+	m_err << "  qfloptool-cli extract [--format <fmt>] [--filesystem <fs>] <image> <destination> [path]" << Qt::endl;
+	m_err << "  qfloptool-cli scan [--output <file.ndjson>] [--resume] [--jobs <n>] [--max-size <bytes>] [--cache <file> | --no-cache] <directory>" << Qt::endl;
+}
+
+
+//-------------------------------------------------
+//  identify
+//-------------------------------------------------
+
+int CliEngine::identify(QCommandLineParser &parser, const QStringList &arguments)
+{
+	QCommandLineOption exhaustiveOption("exhaustive", "Probe every format, bypassing the prefilter and the cache");
+	parser.addOption(exhaustiveOption);
+	parser.addPositionalArgument("image", "Image file");
+	if (!parser.parse(arguments) || parser.positionalArguments().size() != 2)
+	{
+		usage();
+		return 1;
+	}
+
+	MappedFile::ptr file = openImage(parser.positionalArguments()[1]);
+	if (!file)
+		return 1;
+
+	Floptool::IdentifyMode mode = parser.isSet(exhaustiveOption)
+		? Floptool::IdentifyMode::Exhaustive
+		: Floptool::IdentifyMode::Prefiltered;
+	std::vector<Floptool::IdentifyResultCategory> results = Floptool::instance().identify(*file, mode);
+	if (results.empty())
+	{
+		m_err << "Unable to identify image" << Qt::endl;
+		return 1;
+	}
+
+	// one line per result: category, format name, score and description
+	for (const Floptool::IdentifyResultCategory &category : results)
+	{
+		for (const Floptool::IdentifyResult &result : category)
+		{
+			const Floptool::FloppyFormat &floppyFormat = std::get<1>(result);
+			m_out << category.categoryName() << '\t' << floppyFormat.name() << '\t'
+				<< (int)std::get<0>(result) << '\t' << floppyFormat.description() << Qt::endl;
+		}
+	}
+	return 0;
+}
+
+
+//-------------------------------------------------
+//  list
+//-------------------------------------------------
+
+int CliEngine::list(QCommandLineParser &parser, const QStringList &arguments)
+{
+	QCommandLineOption formatOption("format", "Floppy format name", "fmt");
+	QCommandLineOption fileSystemOption("filesystem", "File system name", "fs");
+	QCommandLineOption recursiveOption(QStringList() << "r" << "recursive", "List subdirectories");
+	parser.addOption(formatOption);
+	parser.addOption(fileSystemOption);
+	parser.addOption(recursiveOption);
+	parser.addPositionalArgument("image", "Image file");
+	parser.addPositionalArgument("path", "Directory on the image", "[path]");
+	if (!parser.parse(arguments) || parser.positionalArguments().size() < 2 || parser.positionalArguments().size() > 3)
+	{
+		usage();
+		return 1;
+	}
+
+	MappedFile::ptr file = openImage(parser.positionalArguments()[1]);
+	if (!file)
+		return 1;
+	Floptool::Image::ptr image = mountImage(file, parser.value(formatOption), parser.value(fileSystemOption));
+	if (!image)
+		return 1;
+
+	std::vector<std::string> path = parser.positionalArguments().size() > 2
+		? splitImagePath(parser.positionalArguments()[2])
+		: std::vector<std::string>();
+	return listDirectory(*image, path, parser.isSet(recursiveOption)) ? 0 : 1;
+}
+
+
+//-------------------------------------------------
+//  extract
+//-------------------------------------------------
+
+int CliEngine::extract(QCommandLineParser &parser, const QStringList &arguments)
+{
+	QCommandLineOption formatOption("format", "Floppy format name", "fmt");
+	QCommandLineOption fileSystemOption("filesystem", "File system name", "fs");
+	parser.addOption(formatOption);
+	parser.addOption(fileSystemOption);
+	parser.addPositionalArgument("image", "Image file");
+	parser.addPositionalArgument("destination", "Destination directory on the host");
+	parser.addPositionalArgument("path", "File or directory on the image", "[path]");
+	if (!parser.parse(arguments) || parser.positionalArguments().size() < 3 || parser.positionalArguments().size() > 4)
+	{
+		usage();
+		return 1;
+	}
+
+	MappedFile::ptr file = openImage(parser.positionalArguments()[1]);
+	if (!file)
+		return 1;
+	Floptool::Image::ptr image;
+	try
+	{
+		image = mountImage(file, parser.value(formatOption), parser.value(fileSystemOption));
+	}
+	catch (const std::exception &ex)
+	{
+		// MAME's file system code throws on sufficiently corrupt images
+		m_err << "Unable to mount " << parser.positionalArguments()[1] << ": " << ex.what() << Qt::endl;
+		return 1;
+	}
+	if (!image)
+		return 1;
+
+	// the destination directory is created as needed; whatever we extract goes inside it
+	QString destinationDirectory = parser.positionalArguments()[2];
+	if (!QDir().mkpath(destinationDirectory))
+	{
+		m_err << "Unable to create " << destinationDirectory << Qt::endl;
+		return 1;
+	}
+
+	// the root of the image is extracted into the destination itself, anything else
+	// under its own name
+	std::vector<std::string> path = parser.positionalArguments().size() > 3
+		? splitImagePath(parser.positionalArguments()[3])
+		: std::vector<std::string>();
+	QString destination = !path.empty()
+		? QDir(destinationDirectory).filePath(image->convert(path.back()))
+		: destinationDirectory;
+
+	// the extractor works off of a snapshot of the file system, survives whatever MAME
+	// throws on corrupt images, and overlaps reading the image with writing files
+	Extractor extractor(*image);
+	extractor.add(std::move(path), std::move(destination));
+	extractor.start().waitForFinished();
+
+	Extractor::Progress progress = extractor.progress();
+	if (progress.m_errorCount > 0)
+	{
+		m_err << progress.m_errorCount << " item(s) could not be extracted" << Qt::endl;
+		return 1;
+	}
+	return 0;
+}
+
+
+//-------------------------------------------------
+//  scan - identifies and mounts every file under a
+//	directory, emitting one JSON record per line
+//-------------------------------------------------
+
+int CliEngine::scan(QCommandLineParser &parser, const QStringList &arguments)
+{
+	QCommandLineOption outputOption("output", "NDJSON output file (default is standard output)", "file");
+	QCommandLineOption resumeOption("resume", "Skip images already recorded in the output file, and append to it");
+	QCommandLineOption jobsOption("jobs", "Number of images processed concurrently", "n", QString::number(QThread::idealThreadCount()));
+	QCommandLineOption maxSizeOption("max-size", "Skip images larger than this many bytes", "bytes", QString::number(64 * 1024 * 1024));
+	QCommandLineOption cacheOption("cache", "Identify cache file (default is one set aside for scans)", "file");
+	QCommandLineOption noCacheOption("no-cache", "Do not cache identify results");
+	parser.addOption(outputOption);
+	parser.addOption(resumeOption);
+	parser.addOption(jobsOption);
+	parser.addOption(maxSizeOption);
+	parser.addOption(cacheOption);
+	parser.addOption(noCacheOption);
+	parser.addPositionalArgument("directory", "Directory to scan");
+	if (!parser.parse(arguments) || parser.positionalArguments().size() != 2
+		|| (parser.isSet(resumeOption) && !parser.isSet(outputOption))
+		|| (parser.isSet(cacheOption) && parser.isSet(noCacheOption)))
+	{
+		usage();
+		return 1;
+	}
+	int jobs = std::max(parser.value(jobsOption).toInt(), 1);
+	std::uint64_t maximumSize = parser.value(maxSizeOption).toULongLong();
+
+	// a bulk scan would flush the interactive identify cache, so it does not share it
+	if (parser.isSet(noCacheOption))
+		Floptool::instance().disableIdentifyCache();
+	else
+		Floptool::instance().enableIdentifyCache(parser.isSet(cacheOption) ? parser.value(cacheOption) : IdentifyCache::defaultScanFileName());
+
+	// when resuming, pick up the images that have already been recorded
+	QSet<QString> alreadyScanned;
+	bool isFinalLineTorn = false;
+	if (parser.isSet(resumeOption))
+	{
+		QFile previousOutput(parser.value(outputOption));
+		if (previousOutput.open(QIODevice::ReadOnly))
+		{
+			while (!previousOutput.atEnd())
+			{
+				// a torn final line from an interrupted scan simply fails to parse, and is redone
+				QByteArray line = previousOutput.readLine();
+				isFinalLineTorn = !line.endsWith('\n');
+				QJsonDocument document = QJsonDocument::fromJson(line);
+				QString path = document.isObject()
+					? canonicalPath(document.object().value("path").toString())
+					: QString();
+				if (!path.isEmpty())
+					alreadyScanned.insert(path);
+			}
+		}
+	}
+
+	// set up the output
+	QFile outputFile;
+	QTextStream outputFileStream;
+	QTextStream *output = &m_out;
+	if (parser.isSet(outputOption))
+	{
+		outputFile.setFileName(parser.value(outputOption));
+		QIODevice::OpenMode openMode = parser.isSet(resumeOption)
+			? QIODevice::WriteOnly | QIODevice::Append
+			: QIODevice::WriteOnly | QIODevice::Truncate;
+		if (!outputFile.open(openMode))
+		{
+			m_err << "Unable to open " << outputFile.fileName() << ": " << outputFile.errorString() << Qt::endl;
+			return 1;
+		}
+
+		// terminate the torn line, so that the first new record does not get glued onto it
+		if (isFinalLineTorn && outputFile.write("\n", 1) != 1)
+		{
+			m_err << "Unable to write " << outputFile.fileName() << ": " << outputFile.errorString() << Qt::endl;
+			return 1;
+		}
+		outputFileStream.setDevice(&outputFile);
+		output = &outputFileStream;
+	}
+
+	// walk the directory; the semaphore bounds how many images are in flight (and hence
+	// memory use), while records are flushed as soon as each image is done
+	QThreadPool threadPool;
+	threadPool.setMaxThreadCount(jobs);
+	QSemaphore inFlight(jobs);
+	std::mutex outputMutex;
+	bool writeFailed = false;
+	QDirIterator iter(parser.positionalArguments()[1], QDir::Files | QDir::Readable | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+	while (iter.hasNext())
+	{
+		// paths are recorded in canonical form, so that a rerun can spell the directory
+		// differently and still pick up where the last one left off
+		QString fileName = canonicalPath(iter.next());
+		if (alreadyScanned.contains(fileName))
+			continue;
+
+		inFlight.acquire();
+		threadPool.start([fileName, maximumSize, output, &outputMutex, &writeFailed, &inFlight]
+		{
+			QJsonObject record;
+			try
+			{
+				record = scanImage(fileName, maximumSize);
+			}
+			catch (const std::exception &ex)
+			{
+				// MAME's file system code throws on sufficiently corrupt images
+				record["path"] = fileName;
+				record["error"] = QString("exception: %1").arg(ex.what());
+			}
+			QByteArray line = QJsonDocument(record).toJson(QJsonDocument::Compact);
+			{
+				std::lock_guard lock(outputMutex);
+				*output << line << Qt::endl;
+				if (output->status() != QTextStream::Ok)
+					writeFailed = true;
+			}
+			inFlight.release();
+		});
+	}
+	threadPool.waitForDone();
+
+	// a record that did not make it out would be silently missing from the results
+	if (writeFailed)
+	{
+		QString name = parser.isSet(outputOption) ? outputFile.fileName() : QString("standard output");
+		QString errorString = output->device() ? output->device()->errorString() : QString("write error");
+		m_err << "Unable to write " << name << ": " << errorString << Qt::endl;
+		return 1;
+	}
+	return 0;
+}
+
+
+//-------------------------------------------------
+//  scanImage
+//-------------------------------------------------
+
+QJsonObject CliEngine::scanImage(const QString &fileName, std::uint64_t maximumSize)
+{
+	QJsonObject result;
+	result["path"] = fileName;
+
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		result["error"] = file.errorString();
+		return result;
+	}
+	result["size"] = (qint64)file.size();
+	if ((std::uint64_t)file.size() > maximumSize)
+	{
+		result["error"] = "too large";
+		return result;
+	}
+
+	// identify
+	QElapsedTimer timer;
+	timer.start();
+	MappedFile::ptr mappedFile = MappedFile::open(file);
+	std::vector<Floptool::IdentifyResultCategory> identifyResults = Floptool::instance().identify(*mappedFile);
+	result["identifyMs"] = (qint64)timer.elapsed();
+	if (identifyResults.empty())
+	{
+		result["error"] = "unidentified";
+		return result;
+	}
+	const Floptool::IdentifyResult &bestResult = identifyResults[0][0];
+	result["format"] = std::get<1>(bestResult).get().name();
+	result["formatDescription"] = std::get<1>(bestResult).get().description();
+	result["score"] = (int)std::get<0>(bestResult);
+
+	// mount the best scoring format
+	timer.restart();
+	Floptool::Image::ptr image = mountFirst(mappedFile, { &std::get<1>(bestResult).get() }, nullptr);
+	result["mountMs"] = (qint64)timer.elapsed();
+	if (!image)
+	{
+		result["error"] = "unmountable";
+		return result;
+	}
+	result["fileSystem"] = image->fileSystem().name();
+	std::optional<QString> volumeName = image->volumeName();
+	if (volumeName)
+		result["volumeName"] = *volumeName;
+
+	// and count the files
+	timer.restart();
+	std::vector<std::string> path;
+	result["fileCount"] = countFiles(*image, path);
+	result["listMs"] = (qint64)timer.elapsed();
+	return result;
+}
+
+
+//-------------------------------------------------
+//  countFiles
+//-------------------------------------------------
+
+int CliEngine::countFiles(const Floptool::Image &image, std::vector<std::string> &path)
+{
+	auto [err, entries] = image.mameFileSystem().directory_contents(path);
+	if (err)
+		return 0;
+
+	int result = 0;
+	for (const fs::dir_entry &entry : entries)
+	{
+		if (entry.m_type == fs::dir_entry_type::dir)
+		{
+			path.push_back(entry.m_name);
+			result += countFiles(image, path);
+			path.pop_back();
+		}
+		else
+		{
+			result++;
+		}
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  openImage
+//-------------------------------------------------
+
+MappedFile::ptr CliEngine::openImage(const QString &fileName)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		m_err << "Unable to open " << fileName << ": " << file.errorString() << Qt::endl;
+		return nullptr;
+	}
+	return MappedFile::open(file);
+}
+
+
+//-------------------------------------------------
+//  mountImage - mounts with the requested format and
+//	file system, or the best identified ones
+//-------------------------------------------------
+
+Floptool::Image::ptr CliEngine::mountImage(const MappedFile::ptr &file, const QString &floppyFormatName, const QString &fileSystemName)
+{
+	const Floptool &floptool = Floptool::instance();
+
+	// resolve explicitly specified formats and file systems
+	const Floptool::FloppyFormat *floppyFormat = nullptr;
+	if (!floppyFormatName.isEmpty())
+	{
+		floppyFormat = floptool.findFloppyFormat(floppyFormatName);
+		if (!floppyFormat)
+		{
+			m_err << "Unknown format: " << floppyFormatName << Qt::endl;
+			return {};
+		}
+	}
+	const Floptool::FileSystem *fileSystem = nullptr;
+	if (!fileSystemName.isEmpty())
+	{
+		fileSystem = floptool.findFileSystem(fileSystemName);
+		if (!fileSystem)
+		{
+			m_err << "Unknown file system: " << fileSystemName << Qt::endl;
+			return {};
+		}
+	}
+
+	// build the list of formats to try
+	std::vector<const Floptool::FloppyFormat *> floppyFormats;
+	if (floppyFormat)
+	{
+		floppyFormats.push_back(floppyFormat);
+	}
+	else
+	{
+		for (const Floptool::IdentifyResultCategory &category : floptool.identify(*file))
+		{
+			for (const Floptool::IdentifyResult &result : category)
+				floppyFormats.push_back(&std::get<1>(result).get());
+		}
+	}
+
+	// and try them in order
+	Floptool::Image::ptr image = mountFirst(file, floppyFormats, fileSystem);
+	if (!image)
+		m_err << "Unable to mount image" << Qt::endl;
+	return image;
+}
+
+
+//-------------------------------------------------
+//  mountFirst - tries each format in order, either
+//	against the specified file system or readable
+//	file systems in the same category
+//-------------------------------------------------
+
+Floptool::Image::ptr CliEngine::mountFirst(const MappedFile::ptr &file, const std::vector<const Floptool::FloppyFormat *> &floppyFormats, const Floptool::FileSystem *fileSystem)
+{
+	const Floptool &floptool = Floptool::instance();
+	for (const Floptool::FloppyFormat *floppyFormat : floppyFormats)
+	{
+		// plain sector dumps mount straight from the file; otherwise we decode, but only
+		// once per format regardless of how many file systems we try
+		std::optional<Floptool::DecodedImage::ptr> decodedImage;
+		auto mount = [&floptool, &file, floppyFormat, &decodedImage](const Floptool::FileSystem &thisFileSystem)
+		{
+			Floptool::Image::ptr image = floptool.mountRaw(file, *floppyFormat, thisFileSystem);
+			if (image)
+				return image;
+			if (!decodedImage)
+				decodedImage = floptool.decode(file, *floppyFormat);
+			return *decodedImage
+				? floptool.mount(**decodedImage, thisFileSystem)
+				: Floptool::Image::ptr();
+		};
+
+		if (fileSystem)
+		{
+			Floptool::Image::ptr image = mount(*fileSystem);
+			if (image)
+				return image;
+			continue;
+		}
+
+		const Floptool::Category<Floptool::FloppyFormat> *floppyFormatCategory = floptool.findFloppyFormatCategory(*floppyFormat);
+		for (const Floptool::Category<Floptool::FileSystem> &fileSystemCategory : floptool.fileSystems())
+		{
+			if (floppyFormatCategory && fileSystemCategory.categoryName() != floppyFormatCategory->categoryName())
+				continue;
+
+			for (const Floptool::FileSystem &thisFileSystem : fileSystemCategory)
+			{
+				if (!thisFileSystem.canRead())
+					continue;
+				Floptool::Image::ptr image = mount(thisFileSystem);
+				if (image)
+					return image;
+			}
+		}
+	}
+	return {};
+}
+
+
+//-------------------------------------------------
+//  listDirectory
+//-------------------------------------------------
+
+bool CliEngine::listDirectory(const Floptool::Image &image, std::vector<std::string> &path, bool recursive)
+{
+	std::optional<std::vector<fs::dir_entry>> entries = image.directoryContents(path);
+	if (!entries)
+	{
+		m_err << "Unable to read directory" << Qt::endl;
+		return false;
+	}
+
+	bool success = true;
+
+	for (const fs::dir_entry &entry : *entries)
+	{
+		path.push_back(entry.m_name);
+		bool isDirectory = entry.m_type == fs::dir_entry_type::dir;
+
+		// one line per entry: type, length (if known) and full path
+		QString length = entry.m_meta.has(fs::meta_name::length)
+			? QString::number(entry.m_meta.get_number(fs::meta_name::length))
+			: QString("-");
+		QStringList pathParts;
+		for (const std::string &part : path)
+			pathParts << image.convert(part);
+		m_out << (isDirectory ? 'd' : '-') << '\t' << length << '\t' << pathParts.join('/') << Qt::endl;
+
+		// a bad subdirectory fails the listing, but does not stop it
+		if (recursive && isDirectory)
+			success = listDirectory(image, path, recursive) && success;
+		path.pop_back();
+	}
+	return success;
+}
+
+
+//-------------------------------------------------
+//  canonicalPath
+//-------------------------------------------------
+
+QString CliEngine::canonicalPath(const QString &path)
+{
+	// files that have gone away (or never were) have no canonical path
+	QString result = QFileInfo(path).canonicalFilePath();
+	return !result.isEmpty() ? result : path;
+}
+
+
+//-------------------------------------------------
+//  splitImagePath
+//-------------------------------------------------
+
+std::vector<std::string> CliEngine::splitImagePath(const QString &path)
+{
+	std::vector<std::string> result;
+	for (const QString &part : path.split('/', Qt::SkipEmptyParts))
+		result.push_back(part.toLocal8Bit().toStdString());
+	return result;
+}
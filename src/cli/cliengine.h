@@ -0,0 +1,64 @@
+/***************************************************************************
+
+	cliengine.h
+
+	Headless command line front end
+
+***************************************************************************/
+
+#ifndef CLIENGINE_H
+#define CLIENGINE_H
+
+// qfloptool headers
+#include "floptool.h"
+
+// Qt headers
+#include <QStringList>
+#include <QTextStream>
+
+
+QT_BEGIN_NAMESPACE
+class QCommandLineParser;
+class QJsonObject;
+QT_END_NAMESPACE
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> CliEngine
+
+class CliEngine
+{
+public:
+	// ctor
+	CliEngine(QTextStream &out, QTextStream &err);
+
+	// methods
+	int run(const QStringList &arguments);
+
+private:
+	QTextStream &	m_out;
+	QTextStream &	m_err;
+
+	// commands
+	int identify(QCommandLineParser &parser, const QStringList &arguments);
+	int list(QCommandLineParser &parser, const QStringList &arguments);
+	int extract(QCommandLineParser &parser, const QStringList &arguments);
+	int scan(QCommandLineParser &parser, const QStringList &arguments);
+
+	// helpers
+	void usage();
+	MappedFile::ptr openImage(const QString &fileName);
+	Floptool::Image::ptr mountImage(const MappedFile::ptr &file, const QString &floppyFormatName, const QString &fileSystemName);
+	static Floptool::Image::ptr mountFirst(const MappedFile::ptr &file, const std::vector<const Floptool::FloppyFormat *> &floppyFormats, const Floptool::FileSystem *fileSystem);
+	static QJsonObject scanImage(const QString &fileName, std::uint64_t maximumSize);
+	static int countFiles(const Floptool::Image &image, std::vector<std::string> &path);
+	bool listDirectory(const Floptool::Image &image, std::vector<std::string> &path, bool recursive);
+	static QString canonicalPath(const QString &path);
+	static std::vector<std::string> splitImagePath(const QString &path);
+};
+
+
+#endif // CLIENGINE_H
@@ -0,0 +1,44 @@
+/***************************************************************************
+
+	main.cpp
+
+	Entry point for the headless command line tool
+
+***************************************************************************/
+
+// qfloptool headers
+#include "cliengine.h"
+#include "floptool.h"
+#include "identifycache.h"
+
+// Qt headers
+#include <QCoreApplication>
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  main
+//-------------------------------------------------
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication::setOrganizationName("BletchMAME");
+	QCoreApplication::setApplicationName("qfloptool");
+
+	// instantiate the QCoreApplication; we never need a display
+	QCoreApplication a(argc, argv);
+
+	// instantiate the floptool interface
+	Floptool floptoolInstance;
+	floptoolInstance.initializeMameFormats();
+	floptoolInstance.enableIdentifyCache(IdentifyCache::defaultFileName());
+
+	// and run the command
+	QTextStream out(stdout);
+	QTextStream err(stderr);
+	CliEngine engine(out, err);
+	return engine.run(a.arguments());
+}
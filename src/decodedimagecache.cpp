@@ -0,0 +1,90 @@
+/***************************************************************************
+
+	decodedimagecache.cpp
+
+	LRU cache of decoded floppy images
+
+***************************************************************************/
+
+// qfloptool headers
+#include "decodedimagecache.h"
+
+// C++ headers
+#include <algorithm>
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+DecodedImageCache::DecodedImageCache(std::size_t capacity)
+	: m_capacity(capacity)
+{
+}
+
+
+//-------------------------------------------------
+//  decode - returns a cached decoded image, or
+//	decodes and caches it
+//-------------------------------------------------
+
+Floptool::DecodedImage::ptr DecodedImageCache::decode(const MappedFile::ptr &file, const Floptool::FloppyFormat &format)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		Floptool::DecodedImage::ptr decodedImage = find(file.get(), format);
+		if (decodedImage)
+			return decodedImage;
+	}
+
+	// decoding is the expensive part; we do it outside of the lock
+	Floptool::DecodedImage::ptr decodedImage = Floptool::instance().decode(file, format);
+	if (!decodedImage)
+		return {};
+
+	// another thread may have decoded the same image in the meantime; if so, everybody
+	// gets that one, so that the cache does not hold two entries for it
+	std::lock_guard lock(m_mutex);
+	Floptool::DecodedImage::ptr existingDecodedImage = find(file.get(), format);
+	if (existingDecodedImage)
+		return existingDecodedImage;
+	m_entries.push_front({ file.get(), &format, decodedImage });
+	while (m_entries.size() > m_capacity)
+		m_entries.pop_back();
+	return decodedImage;
+}
+
+
+//-------------------------------------------------
+//  find - looks up an entry, and makes it the most
+//	recently used; the caller holds the lock
+//-------------------------------------------------
+
+Floptool::DecodedImage::ptr DecodedImageCache::find(const MappedFile *file, const Floptool::FloppyFormat &format)
+{
+	// entries hold a reference to the mapped file, so its address is a stable key
+	auto iter = std::ranges::find_if(m_entries, [file, &format](const Entry &entry)
+	{
+		return entry.m_file == file && entry.m_format == &format;
+	});
+	if (iter == m_entries.end())
+		return {};
+
+	m_entries.splice(m_entries.begin(), m_entries, iter);
+	return m_entries.front().m_decodedImage;
+}
+
+
+//-------------------------------------------------
+//  clear
+//-------------------------------------------------
+
+void DecodedImageCache::clear()
+{
+	std::lock_guard lock(m_mutex);
+	m_entries.clear();
+}
@@ -0,0 +1,54 @@
+/***************************************************************************
+
+	decodedimagecache.h
+
+	LRU cache of decoded floppy images
+
+***************************************************************************/
+
+#ifndef DECODEDIMAGECACHE_H
+#define DECODEDIMAGECACHE_H
+
+// qfloptool headers
+#include "floptool.h"
+
+// C++ headers
+#include <list>
+#include <mutex>
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> DecodedImageCache
+
+class DecodedImageCache
+{
+public:
+	// ctor
+	DecodedImageCache(std::size_t capacity = 8);
+	DecodedImageCache(const DecodedImageCache &) = delete;
+	DecodedImageCache(DecodedImageCache &&) = delete;
+
+	// methods
+	Floptool::DecodedImage::ptr decode(const MappedFile::ptr &file, const Floptool::FloppyFormat &format);
+	void clear();
+
+private:
+	struct Entry
+	{
+		const MappedFile *				m_file;
+		const Floptool::FloppyFormat *	m_format;
+		Floptool::DecodedImage::ptr		m_decodedImage;
+	};
+
+	std::mutex			m_mutex;
+	std::list<Entry>	m_entries;		// most recently used first
+	std::size_t			m_capacity;
+
+	Floptool::DecodedImage::ptr find(const MappedFile *file, const Floptool::FloppyFormat &format);
+};
+
+
+#endif // DECODEDIMAGECACHE_H
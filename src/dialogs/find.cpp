@@ -0,0 +1,118 @@
+/***************************************************************************
+
+	find.cpp
+
+	Find File dialog
+
+***************************************************************************/
+
+// qfloptool headers
+#include "find.h"
+#include "ui_find.h"
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+// more than this is not a search result, it is a directory listing
+static const std::size_t s_maximumResultCount = 1000;
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+FindDialog::FindDialog(QFuture<SearchIndex::ptr> &&searchIndexFuture, QWidget *parent)
+	: QDialog(parent)
+{
+	m_ui = std::make_unique<Ui::FindDialog>();
+	m_ui->setupUi(this);
+
+	// the index may still be building; until it is, we can only say so
+	m_ui->statusLabel->setText("Indexing...");
+	connect(&m_searchIndexWatcher, &QFutureWatcher<SearchIndex::ptr>::finished, this, [this]()
+	{
+		searchIndexFinished();
+	});
+	m_searchIndexWatcher.setFuture(std::move(searchIndexFuture));
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+FindDialog::~FindDialog()
+{
+}
+
+
+//-------------------------------------------------
+//  searchIndexFinished
+//-------------------------------------------------
+
+void FindDialog::searchIndexFinished()
+{
+	QFuture<SearchIndex::ptr> future = m_searchIndexWatcher.future();
+	if (!future.isCanceled() && future.resultCount() > 0)
+		m_searchIndex = future.result();
+
+	if (m_searchIndex)
+		updateResults();
+	else
+		m_ui->statusLabel->setText("Unable to index this image");
+}
+
+
+//-------------------------------------------------
+//  updateResults
+//-------------------------------------------------
+
+void FindDialog::updateResults()
+{
+	m_ui->resultsListWidget->clear();
+	QString query = m_ui->queryLineEdit->text();
+	if (query.isEmpty())
+	{
+		m_ui->statusLabel->setText(QString("%1 files and directories").arg(m_searchIndex->entryCount()));
+		return;
+	}
+
+	std::vector<int> entryIndexes = m_searchIndex->find(query, s_maximumResultCount);
+	for (int entryIndex : entryIndexes)
+	{
+		QListWidgetItem &item = *new QListWidgetItem(m_searchIndex->displayPath(entryIndex), m_ui->resultsListWidget);
+		item.setData(Qt::UserRole, entryIndex);
+	}
+
+	m_ui->statusLabel->setText(entryIndexes.size() < s_maximumResultCount
+		? QString("%1 matches").arg(entryIndexes.size())
+		: QString("First %1 matches").arg(entryIndexes.size()));
+}
+
+
+//-------------------------------------------------
+//  on_queryLineEdit_textChanged
+//-------------------------------------------------
+
+void FindDialog::on_queryLineEdit_textChanged(const QString &text)
+{
+	if (m_searchIndex)
+		updateResults();
+}
+
+
+//-------------------------------------------------
+//  on_resultsListWidget_itemActivated
+//-------------------------------------------------
+
+void FindDialog::on_resultsListWidget_itemActivated(QListWidgetItem *item)
+{
+	if (m_searchIndex && item)
+		emit pathActivated(m_searchIndex->path(item->data(Qt::UserRole).toInt()));
+}
@@ -0,0 +1,54 @@
+/***************************************************************************
+
+	find.h
+
+	Find File dialog
+
+***************************************************************************/
+
+#ifndef FIND_H
+#define FIND_H
+
+// qfloptool includes
+#include "../searchindex.h"
+
+// Qt includes
+#include <QDialog>
+#include <QFuture>
+#include <QFutureWatcher>
+
+
+QT_BEGIN_NAMESPACE
+namespace Ui { class FindDialog; }
+class QListWidgetItem;
+QT_END_NAMESPACE
+
+// ======================> FindDialog
+
+class FindDialog : public QDialog
+{
+	Q_OBJECT
+
+public:
+	// ctor/dtor
+	FindDialog(QFuture<SearchIndex::ptr> &&searchIndexFuture, QWidget *parent = nullptr);
+	~FindDialog();
+
+signals:
+	void pathActivated(const std::vector<std::string> &path);
+
+private slots:
+	void on_queryLineEdit_textChanged(const QString &text);
+	void on_resultsListWidget_itemActivated(QListWidgetItem *item);
+
+private:
+	std::unique_ptr<Ui::FindDialog>		m_ui;
+	QFutureWatcher<SearchIndex::ptr>	m_searchIndexWatcher;
+	SearchIndex::ptr					m_searchIndex;
+
+	void searchIndexFinished();
+	void updateResults();
+};
+
+
+#endif // FIND_H
@@ -1,399 +1,839 @@
-/***************************************************************************
-
-	identify.cpp
-
-	Image identification dialog
-
-***************************************************************************/
-
-// qfloptool headers
-#include "identify.h"
-#include "ui_identify.h"
-#include "../floptool.h"
-#include "../imageitemmodel.h"
-
-// Qt headers
-#include <QFontDatabase>
-#include <QStringListModel>
-
-// C++ headers
-#include <algorithm>
-
-
-//**************************************************************************
-//  TYPE DEFINITIONS
-//**************************************************************************
-
-namespace
-{
-	// ======================> CategoryItemListModel
-	template<class T>
-	class CategoryItemListModel : public QAbstractItemModel
-	{
-	public:
-		CategoryItemListModel(const std::vector<Floptool::Category<T>> &items, QObject *parent = nullptr);
-
-		// methods
-		QModelIndex findFirstModelIndexForCategory(const QString *categoryName = nullptr) const;
-		const T *getItem(const QModelIndex &index) const;
-
-		// virtuals
-		virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override final;
-		virtual QModelIndex parent(const QModelIndex &child) const override final;
-		virtual int rowCount(const QModelIndex &parent) const override final;
-		virtual int columnCount(const QModelIndex &parent) const override final;
-		virtual bool hasChildren(const QModelIndex &parent) const final;
-		virtual Qt::ItemFlags flags(const QModelIndex &index) const override final;
-		virtual QVariant data(const QModelIndex &index, int role) const override final;
-
-	protected:
-		virtual QString displayData(const T &item) const = 0;
-		virtual bool itemEnabled(const T &item) const = 0;
-
-	private:
-		const std::vector<Floptool::Category<T>> &	m_items;
-	};
-
-
-	// ======================> IdentifyResultsListModel
-	class IdentifyResultsListModel : public CategoryItemListModel<Floptool::IdentifyResult>
-	{
-	public:
-		using CategoryItemListModel::CategoryItemListModel;
-
-	protected:
-		virtual QString displayData(const Floptool::IdentifyResult &item) const override final;
-		virtual bool itemEnabled(const Floptool::IdentifyResult &item) const override final;
-	};
-
-
-	// ======================> FileSystemsListModel
-	class FileSystemsListModel : public CategoryItemListModel<Floptool::FileSystem>
-	{
-	public:
-		using CategoryItemListModel::CategoryItemListModel;
-
-	protected:
-		virtual QString displayData(const Floptool::FileSystem &item) const override final;
-		virtual bool itemEnabled(const Floptool::FileSystem &item) const override final;
-	};
-};
-
-//**************************************************************************
-//  IMPLEMENTATION
-//**************************************************************************
-
-//-------------------------------------------------
-//  ctor
-//-------------------------------------------------
-
-IdentifyDialog::IdentifyDialog(QIODevice &file, const std::vector<Floptool::IdentifyResultCategory> &ident, QWidget *parent)
-	: m_file(file)
-	, m_ident(ident)
-{
-	// set up UI
-	m_ui = std::make_unique<Ui::IdentifyDialog>();
-	m_ui->setupUi(this);
-
-	// cosmetic (why can't this be done in identify.ui?)
-	QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
-	m_ui->previewTreeView->setFont(font);
-
-	// set up the format list model
-	QStringList formatDescs;
-	IdentifyResultsListModel &identifyResultsModel = *new IdentifyResultsListModel(m_ident, this);
-	m_ui->identifyResultsTreeView->setModel(&identifyResultsModel);
-	m_ui->identifyResultsTreeView->expandAll();
-
-	// set up the file systems list model
-	FileSystemsListModel &fileSystemsModel = *new FileSystemsListModel(Floptool::instance().fileSystems(), this);
-	m_ui->fileSystemsTreeView->setModel(&fileSystemsModel);
-	m_ui->fileSystemsTreeView->expandAll();
-
-	// set the proper selections
-	QModelIndex identifyResultsSelection = identifyResultsModel.findFirstModelIndexForCategory();
-	m_ui->identifyResultsTreeView->selectionModel()->select(identifyResultsSelection, QItemSelectionModel::SelectCurrent);
-	QModelIndex fileSystemsSelection = fileSystemsModel.findFirstModelIndexForCategory(&m_ident[0].categoryName());
-	m_ui->fileSystemsTreeView->selectionModel()->select(fileSystemsSelection, QItemSelectionModel::SelectCurrent);
-
-	// listen to selection events
-	connect(m_ui->identifyResultsTreeView->selectionModel(), &QItemSelectionModel::selectionChanged, this, [this](const QItemSelection &selected, const QItemSelection &deselected)
-	{
-		updatePreview();
-	});
-	connect(m_ui->fileSystemsTreeView->selectionModel(), &QItemSelectionModel::selectionChanged, this, [this](const QItemSelection &selected, const QItemSelection &deselected)
-	{
-		updatePreview();
-	});
-	updatePreview();
-}
-
-
-//-------------------------------------------------
-//  dtor
-//-------------------------------------------------
-
-IdentifyDialog::~IdentifyDialog()
-{
-}
-
-
-//-------------------------------------------------
-//  updatePreview
-//-------------------------------------------------
-
-void IdentifyDialog::updatePreview()
-{
-	IdentifyResultsListModel &identifyResultsModel = *dynamic_cast<IdentifyResultsListModel *>(m_ui->identifyResultsTreeView->model());
-	FileSystemsListModel &fileSystemsModel = *dynamic_cast<FileSystemsListModel *>(m_ui->fileSystemsTreeView->model());
-
-	QModelIndexList identifyResultsSelectedIndexes = m_ui->identifyResultsTreeView->selectionModel()->selectedIndexes();
-	QModelIndexList fileSystemsSelectedIndexes = m_ui->fileSystemsTreeView->selectionModel()->selectedIndexes();
-	const Floptool::IdentifyResult *identifyResult = !identifyResultsSelectedIndexes.empty()
-		? identifyResultsModel.getItem(identifyResultsSelectedIndexes[0])
-		: nullptr;
-	const Floptool::FileSystem *fileSystem = !fileSystemsSelectedIndexes.empty()
-		? fileSystemsModel.getItem(fileSystemsSelectedIndexes[0])
-		: nullptr;
-
-	// delete the old model, if necessary
-	QAbstractItemModel *oldModel = m_ui->previewTreeView->model();
-	if (oldModel)
-		delete oldModel;
-	if (!identifyResult || !fileSystem)
-		return;
-
-	// try to load the image
-	Floptool::Image::ptr image = Floptool::instance().mount(m_file, std::get<1>(*identifyResult), *fileSystem);
-	if (!image)
-		return;
-
-	// set up a preview model
-	ImageItemModel &previewModel = *new ImageItemModel(std::move(image), this);
-	m_ui->previewTreeView->setModel(&previewModel);
-}
-
-
-//-------------------------------------------------
-//  detachImage
-//-------------------------------------------------
-
-Floptool::Image::ptr IdentifyDialog::detachImage()
-{
-	ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->previewTreeView->model());
-	return model ? model->detachImage() : nullptr;
-}
-
-
-//-------------------------------------------------
-//  CategoryItemListModel ctor
-//-------------------------------------------------
-
-template<class T>
-CategoryItemListModel<T>::CategoryItemListModel(const std::vector<Floptool::Category<T>> &items, QObject *parent)
-	: QAbstractItemModel(parent)
-	, m_items(items)
-{
-}
-
-
-//-------------------------------------------------
-//  CategoryItemListModel::findFirstModelIndexForCategory
-//-------------------------------------------------
-
-template<class T>
-QModelIndex CategoryItemListModel<T>::findFirstModelIndexForCategory(const QString *categoryName) const
-{
-	for (int row = 0; row < m_items.size(); row++)
-	{
-		if (!categoryName || m_items[row].categoryName() == *categoryName)
-		{
-			QModelIndex parentIndex = index(row, 0);
-			return index(0, 0, parentIndex);
-		}
-	}
-	return QModelIndex();
-}
-
-
-//-------------------------------------------------
-//  CategoryItemListModel::getItem
-//-------------------------------------------------
-
-template<class T>
-const T *CategoryItemListModel<T>::getItem(const QModelIndex &index) const
-{
-	return index.internalId() != ~0
-		? &m_items[index.internalId()][index.row()]
-		: nullptr;
-}
-
-
-//-------------------------------------------------
-//  CategoryItemListModel::index
-//-------------------------------------------------
-
-template<class T>
-QModelIndex CategoryItemListModel<T>::index(int row, int column, const QModelIndex &parent) const
-{
-	QModelIndex result = createIndex(row, column, parent.isValid() ? parent.row() : ~0);
-	assert(result.isValid());
-	return result;
-}
-
-
-//-------------------------------------------------
-//  CategoryItemListModel::parent
-//-------------------------------------------------
-
-template<class T>
-QModelIndex CategoryItemListModel<T>::parent(const QModelIndex &child) const
-{
-	return child.internalId() != ~0
-		? index(child.internalId(), child.column())
-		: QModelIndex();
-}
-
-
-//-------------------------------------------------
-//  CategoryItemListModel::rowCount
-//-------------------------------------------------
-
-template<class T>
-int CategoryItemListModel<T>::rowCount(const QModelIndex &parent) const
-{
-	int result;
-	if (parent.isValid())
-	{
-		// filesystem entry
-		result = m_items[parent.row()].size();
-	}
-	else
-	{
-		// filesystem category
-		result = m_items.size();
-	}
-	return result;
-}
-
-
-//-------------------------------------------------
-//  CategoryItemListModel::columnCount
-//-------------------------------------------------
-
-template<class T>
-int CategoryItemListModel<T>::columnCount(const QModelIndex &parent) const
-{
-	return 1;
-}
-
-
-//-------------------------------------------------
-//  CategoryItemListModel::hasChildren
-//-------------------------------------------------
-
-template<class T>
-bool CategoryItemListModel<T>::hasChildren(const QModelIndex &parent) const
-{
-	return !parent.isValid() || parent.internalId() == ~0;
-}
-
-
-//-------------------------------------------------
-//  CategoryItemListModel::flags
-//-------------------------------------------------
-
-template<class T>
-Qt::ItemFlags CategoryItemListModel<T>::flags(const QModelIndex &index) const
-{
-	bool isEnabled = index.internalId() != ~0
-		? itemEnabled(m_items[index.internalId()][index.row()])
-		: true;
-
-	Qt::ItemFlags result = isEnabled ? Qt::ItemIsEnabled : (Qt::ItemFlags)0;
-	if (index.internalId() != ~0)
-		result |= Qt::ItemIsSelectable | Qt::ItemNeverHasChildren;
-	return result;
-}
-
-
-//-------------------------------------------------
-//  CategoryItemListModel::data
-//-------------------------------------------------
-
-template<class T>
-QVariant CategoryItemListModel<T>::data(const QModelIndex &index, int role) const
-{
-	QVariant result;
-	const T *item = getItem(index);
-	if (item)
-	{
-		// item entry
-		switch (role)
-		{
-		case Qt::DisplayRole:
-			result = displayData(*item);
-			break;
-		}
-	}
-	else
-	{
-		// item category
-		switch (role)
-		{
-		case Qt::DisplayRole:
-			result = m_items[index.row()].categoryName();
-			break;
-
-		case Qt::FontRole:
-			{
-				QFont font;
-				font.setUnderline(true);
-				result = std::move(font);
-			}
-			break;
-		}
-	}
-	return result;
-}
-
-
-//-------------------------------------------------
-//  IdentifyResultsListModel::displayData
-//-------------------------------------------------
-
-QString IdentifyResultsListModel::displayData(const Floptool::IdentifyResult &item) const
-{
-	const Floptool::FloppyFormat &floppyFormat = std::get<1>(item);
-	return floppyFormat.description();
-}
-
-
-//-------------------------------------------------
-//  FileSystemsListModel::itemEnabled
-//-------------------------------------------------
-
-bool IdentifyResultsListModel::itemEnabled(const Floptool::IdentifyResult &item) const
-{
-	return true;
-}
-
-
-//-------------------------------------------------
-//  FileSystemsListModel::displayData
-//-------------------------------------------------
-
-QString FileSystemsListModel::displayData(const Floptool::FileSystem &item) const
-{
-	return item.description();
-}
-
-
-//-------------------------------------------------
-//  FileSystemsListModel::itemEnabled
-//-------------------------------------------------
-
-bool FileSystemsListModel::itemEnabled(const Floptool::FileSystem &item) const
-{
-	return item.canRead();
-}
+/***************************************************************************
+
+	identify.cpp
+
+	Image identification dialog
+
+***************************************************************************/
+
+// qfloptool headers
+#include "identify.h"
+#include "ui_identify.h"
+#include "../floptool.h"
+#include "../imageitemmodel.h"
+
+// Qt headers
+#include <QFontDatabase>
+#include <QStringListModel>
+#include <QThread>
+#include <QtConcurrent>
+
+// C++ headers
+#include <algorithm>
+
+
+//**************************************************************************
+//  TYPE DEFINITIONS
+//**************************************************************************
+
+namespace
+{
+	// ======================> CategoryItemListModel
+	template<class T>
+	class CategoryItemListModel : public QAbstractItemModel
+	{
+	public:
+		CategoryItemListModel(const std::vector<Floptool::Category<T>> &items, QObject *parent = nullptr);
+
+		// methods
+		QModelIndex findFirstModelIndexForCategory(const QString *categoryName = nullptr) const;
+		QModelIndex findModelIndex(const T &item) const;
+		const T *getItem(const QModelIndex &index) const;
+
+		// virtuals
+		virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override final;
+		virtual QModelIndex parent(const QModelIndex &child) const override final;
+		virtual int rowCount(const QModelIndex &parent) const override final;
+		virtual int columnCount(const QModelIndex &parent) const override final;
+		virtual bool hasChildren(const QModelIndex &parent) const final;
+		virtual Qt::ItemFlags flags(const QModelIndex &index) const override final;
+		virtual QVariant data(const QModelIndex &index, int role) const override final;
+
+	protected:
+		virtual QString displayData(const T &item) const = 0;
+		virtual bool itemEnabled(const T &item) const = 0;
+
+	private:
+		const std::vector<Floptool::Category<T>> &	m_items;
+	};
+
+
+	// ======================> IdentifyResultsListModel
+	class IdentifyResultsListModel : public CategoryItemListModel<Floptool::IdentifyResult>
+	{
+	public:
+		using CategoryItemListModel::CategoryItemListModel;
+
+	protected:
+		virtual QString displayData(const Floptool::IdentifyResult &item) const override final;
+		virtual bool itemEnabled(const Floptool::IdentifyResult &item) const override final;
+	};
+
+
+	// ======================> FileSystemsListModel
+	class FileSystemsListModel : public CategoryItemListModel<Floptool::FileSystem>
+	{
+	public:
+		using CategoryItemListModel::CategoryItemListModel;
+
+	protected:
+		virtual QString displayData(const Floptool::FileSystem &item) const override final;
+		virtual bool itemEnabled(const Floptool::FileSystem &item) const override final;
+	};
+};
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+// how many of the top identify results to mount speculatively
+static const std::size_t s_speculativeMountCount = 4;
+
+// rough memory budget for speculative mounts; each mount is assumed to cost a few
+// multiples of the image file (decoded tracks plus the converted sector image)
+static const qint64 s_speculativeMountBudget = 256 * 1024 * 1024;
+static const qint64 s_speculativeMountExpansion = 4;
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+IdentifyDialog::IdentifyDialog(MappedFile::ptr &&file, const std::vector<Floptool::IdentifyResultCategory> &ident, QWidget *parent)
+	: m_file(std::move(file))
+	, m_ident(ident)
+	, m_autoDetectFloppyFormat(nullptr)
+	, m_fileSystemChosenByUser(false)
+	, m_selectingFileSystem(false)
+{
+	// set up UI
+	m_ui = std::make_unique<Ui::IdentifyDialog>();
+	m_ui->setupUi(this);
+
+	// cosmetic (why can't this be done in identify.ui?)
+	QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+	m_ui->previewTreeView->setFont(font);
+
+	// set up the format list model
+	QStringList formatDescs;
+	IdentifyResultsListModel &identifyResultsModel = *new IdentifyResultsListModel(m_ident, this);
+	m_ui->identifyResultsTreeView->setModel(&identifyResultsModel);
+	m_ui->identifyResultsTreeView->expandAll();
+
+	// set up the file systems list model
+	FileSystemsListModel &fileSystemsModel = *new FileSystemsListModel(Floptool::instance().fileSystems(), this);
+	m_ui->fileSystemsTreeView->setModel(&fileSystemsModel);
+	m_ui->fileSystemsTreeView->expandAll();
+
+	// set the proper selections
+	QModelIndex identifyResultsSelection = identifyResultsModel.findFirstModelIndexForCategory();
+	m_ui->identifyResultsTreeView->selectionModel()->select(identifyResultsSelection, QItemSelectionModel::SelectCurrent);
+	QModelIndex fileSystemsSelection = fileSystemsModel.findFirstModelIndexForCategory(&m_ident[0].categoryName());
+	m_ui->fileSystemsTreeView->selectionModel()->select(fileSystemsSelection, QItemSelectionModel::SelectCurrent);
+
+	// mounts happen in the background; the watcher tells us when they are done
+	connect(&m_mountWatcher, &QFutureWatcherBase::progressValueChanged, this, [this](int progressValue)
+	{
+		mountProgressChanged(progressValue);
+	});
+	connect(&m_mountWatcher, &QFutureWatcherBase::finished, this, [this]()
+	{
+		mountFinished();
+	});
+	connect(&m_autoDetectWatcher, &QFutureWatcherBase::finished, this, [this]()
+	{
+		autoDetectFinished();
+	});
+
+	// listen to selection events
+	connect(m_ui->identifyResultsTreeView->selectionModel(), &QItemSelectionModel::selectionChanged, this, [this](const QItemSelection &selected, const QItemSelection &deselected)
+	{
+		updatePreview();
+		startAutoDetect();
+	});
+	connect(m_ui->fileSystemsTreeView->selectionModel(), &QItemSelectionModel::selectionChanged, this, [this](const QItemSelection &selected, const QItemSelection &deselected)
+	{
+		if (!m_selectingFileSystem)
+			m_fileSystemChosenByUser = true;
+		updatePreview();
+	});
+	updatePreview();
+
+	// the file system selected above is only a guess; try them all to find the right one
+	startAutoDetect();
+
+	// while the user looks at the dialog, mount the other likely candidates so that switching
+	// between them is instant
+	m_speculativeThreadPool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+	startSpeculativeMounts();
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+IdentifyDialog::~IdentifyDialog()
+{
+	// stale mounts may still be running against our decoded image cache
+	m_mountFuture.cancel();
+	m_autoDetectFuture.cancel();
+	cancelSpeculativeMounts();
+	m_mountThreadPool.waitForDone();
+	m_speculativeThreadPool.waitForDone();
+}
+
+
+//-------------------------------------------------
+//  startMount
+//-------------------------------------------------
+
+QFuture<Floptool::Image::ptr> IdentifyDialog::startMount(QThreadPool &threadPool, const Floptool::FloppyFormat &floppyFormat, const Floptool::FileSystem &fileSystem)
+{
+	// decode and mount the image in the background; decoding is cached, so that switching
+	// file systems only redoes the mount
+	return QtConcurrent::run(&threadPool, [this, file = m_file, &floppyFormat, &fileSystem](QPromise<Floptool::Image::ptr> &promise)
+	{
+		try
+		{
+			// plain sector dumps do not need decoding at all
+			promise.setProgressRange(0, 2);
+			Floptool::Image::ptr rawImage = Floptool::instance().mountRaw(file, floppyFormat, fileSystem);
+			if (rawImage)
+			{
+				if (!promise.isCanceled())
+					promise.addResult(std::move(rawImage));
+				return;
+			}
+
+			Floptool::DecodedImage::ptr decodedImage = m_decodedImageCache.decode(file, floppyFormat);
+			if (!decodedImage || promise.isCanceled())
+				return;
+
+			promise.setProgressValue(1);
+			Floptool::Image::ptr image = Floptool::instance().mount(*decodedImage, fileSystem);
+			if (image && !promise.isCanceled())
+				promise.addResult(std::move(image));
+		}
+		catch (...)
+		{
+			// MAME file system code can throw on corrupt images; treat this as a failed mount
+		}
+	});
+}
+
+
+//-------------------------------------------------
+//  startSpeculativeMounts
+//-------------------------------------------------
+
+void IdentifyDialog::startSpeculativeMounts()
+{
+	const qint64 estimatedCost = std::max<qint64>((qint64)m_file->size(), 1) * s_speculativeMountExpansion;
+	qint64 budget = s_speculativeMountBudget;
+
+	// updatePreview() is already mounting whatever is selected
+	const Floptool::FloppyFormat *selectedFormat = selectedFloppyFormat();
+	const Floptool::FileSystem *selectedFs = selectedFileSystem();
+
+	for (const Floptool::IdentifyResultCategory &category : m_ident)
+	{
+		// pair each result with the file system the dialog would select by default
+		const Floptool::FileSystem *fileSystem = nullptr;
+		for (const Floptool::Category<Floptool::FileSystem> &fileSystemCategory : Floptool::instance().fileSystems())
+		{
+			if (fileSystemCategory.categoryName() == category.categoryName())
+			{
+				auto iter = std::ranges::find_if(fileSystemCategory, [](const Floptool::FileSystem &x) { return x.canRead(); });
+				if (iter != fileSystemCategory.end())
+					fileSystem = &*iter;
+				break;
+			}
+		}
+		if (!fileSystem)
+			continue;
+
+		for (const Floptool::IdentifyResult &identifyResult : category)
+		{
+			const Floptool::FloppyFormat &floppyFormat = std::get<1>(identifyResult);
+			if (&floppyFormat == selectedFormat && fileSystem == selectedFs)
+				continue;
+			if (m_speculativeMounts.size() >= s_speculativeMountCount || budget < estimatedCost)
+				return;
+
+			QFuture<Floptool::Image::ptr> future = startMount(m_speculativeThreadPool, floppyFormat, *fileSystem);
+			m_speculativeMounts.push_back({ &floppyFormat, fileSystem, std::move(future) });
+			budget -= estimatedCost;
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  takeSpeculativeMount
+//-------------------------------------------------
+
+std::optional<QFuture<Floptool::Image::ptr>> IdentifyDialog::takeSpeculativeMount(const Floptool::FloppyFormat &floppyFormat, const Floptool::FileSystem &fileSystem)
+{
+	std::optional<QFuture<Floptool::Image::ptr>> result;
+	auto iter = std::ranges::find_if(m_speculativeMounts, [&floppyFormat, &fileSystem](const SpeculativeMount &x)
+	{
+		return x.m_floppyFormat == &floppyFormat && x.m_fileSystem == &fileSystem;
+	});
+	if (iter != m_speculativeMounts.end())
+	{
+		// a speculative mount that has not even started yet would only make us wait behind
+		// the others; drop it and let the caller mount directly
+		if (iter->m_future.isStarted())
+			result = std::move(iter->m_future);
+		else
+			iter->m_future.cancel();
+		m_speculativeMounts.erase(iter);
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  retargetSpeculativeMounts
+//-------------------------------------------------
+
+void IdentifyDialog::retargetSpeculativeMounts(const Floptool::FloppyFormat &floppyFormat, const Floptool::FileSystem &fileSystem)
+{
+	// speculative mounts only guessed at the file system; now that we know what it is for
+	// one format, the other formats in its category most likely use it too
+	const Floptool &floptool = Floptool::instance();
+	const Floptool::Category<Floptool::FloppyFormat> *category = floptool.findFloppyFormatCategory(floppyFormat);
+	for (SpeculativeMount &speculativeMount : m_speculativeMounts)
+	{
+		if (speculativeMount.m_floppyFormat == &floppyFormat
+			|| speculativeMount.m_fileSystem == &fileSystem
+			|| floptool.findFloppyFormatCategory(*speculativeMount.m_floppyFormat) != category)
+			continue;
+
+		speculativeMount.m_future.cancel();
+		speculativeMount.m_fileSystem = &fileSystem;
+		speculativeMount.m_future = startMount(m_speculativeThreadPool, *speculativeMount.m_floppyFormat, fileSystem);
+	}
+}
+
+
+//-------------------------------------------------
+//  cancelSpeculativeMounts
+//-------------------------------------------------
+
+void IdentifyDialog::cancelSpeculativeMounts()
+{
+	for (SpeculativeMount &speculativeMount : m_speculativeMounts)
+		speculativeMount.m_future.cancel();
+	m_speculativeMounts.clear();
+}
+
+
+//-------------------------------------------------
+//  startAutoDetect
+//-------------------------------------------------
+
+void IdentifyDialog::startAutoDetect()
+{
+	// whatever we were detecting before was for another format
+	m_autoDetectFuture.cancel();
+	m_autoDetectFuture = QFuture<std::vector<FileSystemDetector::Attempt>>();
+	m_autoDetectFloppyFormat = nullptr;
+	m_autoDetectImage.reset();
+	m_ui->autoDetectLabel->clear();
+	m_ui->autoDetectLabel->setToolTip(QString());
+
+	const Floptool::FloppyFormat *floppyFormat = selectedFloppyFormat();
+	if (!floppyFormat)
+		return;
+
+	// if there is nothing to choose between, there is nothing to detect
+	std::vector<const Floptool::FileSystem *> candidates = FileSystemDetector::candidates(*floppyFormat);
+	if (candidates.size() < 2)
+		return;
+
+	m_autoDetectFloppyFormat = floppyFormat;
+	m_ui->autoDetectLabel->setText(tr("Detecting file system..."));
+	m_autoDetectFuture = QtConcurrent::run(&m_mountThreadPool, [this, file = m_file, floppyFormat, candidates = std::move(candidates)](QPromise<std::vector<FileSystemDetector::Attempt>> &promise)
+	{
+		try
+		{
+			std::vector<FileSystemDetector::Attempt> attempts = FileSystemDetector::detect(file, *floppyFormat, candidates, [this, &file, floppyFormat]()
+			{
+				return m_decodedImageCache.decode(file, *floppyFormat);
+			});
+			if (!promise.isCanceled())
+				promise.addResult(std::move(attempts));
+		}
+		catch (...)
+		{
+			// MAME format code can throw on corrupt images; treat this as nothing detected
+		}
+	});
+	m_autoDetectWatcher.setFuture(m_autoDetectFuture);
+}
+
+
+//-------------------------------------------------
+//  autoDetectFinished
+//-------------------------------------------------
+
+void IdentifyDialog::autoDetectFinished()
+{
+	// ignore notifications for runs we have since cancelled
+	if (!m_autoDetectFuture.isValid() || !m_autoDetectFuture.isFinished())
+		return;
+	if (m_autoDetectFuture.isCanceled() || m_autoDetectFuture.resultCount() == 0)
+	{
+		m_ui->autoDetectLabel->setText(tr("Unable to detect the file system"));
+		return;
+	}
+	std::vector<FileSystemDetector::Attempt> attempts = m_autoDetectFuture.takeResult();
+	m_autoDetectFuture = QFuture<std::vector<FileSystemDetector::Attempt>>();
+
+	// report how every attempt went
+	QStringList lines;
+	FileSystemDetector::Attempt *best = !attempts.empty() && attempts[0].m_score > 0
+		? &attempts[0]
+		: nullptr;
+	lines << (best
+		? tr("Detected file system: %1").arg(best->m_fileSystem->description())
+		: tr("Unable to detect the file system"));
+	for (const FileSystemDetector::Attempt &attempt : attempts)
+	{
+		QString elapsed = QString::number(attempt.m_elapsed.count() / 1000.0, 'f', 1);
+		lines << (attempt.m_score > 0
+			? tr("%1: score %2, %3 ms").arg(attempt.m_fileSystem->description(), QString::number(attempt.m_score), elapsed)
+			: tr("%1: failed, %2 ms").arg(attempt.m_fileSystem->description(), elapsed));
+	}
+	m_ui->autoDetectLabel->setText(lines[0]);
+	m_ui->autoDetectLabel->setToolTip(lines.join('\n'));
+
+	if (!best)
+		return;
+	retargetSpeculativeMounts(*m_autoDetectFloppyFormat, *best->m_fileSystem);
+
+	// the winner is already mounted; hold on to it so that the preview does not have to
+	// mount it all over again
+	m_autoDetectImage = std::move(best->m_image);
+
+	// preselect the winner, unless the user has moved on in the meantime
+	if (!m_fileSystemChosenByUser && selectedFloppyFormat() == m_autoDetectFloppyFormat)
+	{
+		FileSystemsListModel &fileSystemsModel = *dynamic_cast<FileSystemsListModel *>(m_ui->fileSystemsTreeView->model());
+		QModelIndex index = fileSystemsModel.findModelIndex(*best->m_fileSystem);
+		if (index.isValid())
+		{
+			m_selectingFileSystem = true;
+			m_ui->fileSystemsTreeView->selectionModel()->select(index, QItemSelectionModel::ClearAndSelect);
+			m_ui->fileSystemsTreeView->scrollTo(index);
+			m_selectingFileSystem = false;
+		}
+	}
+
+	// if the winner was already selected, the preview is still busy mounting it
+	if (m_autoDetectImage && m_mountFuture.isValid()
+		&& selectedFloppyFormat() == m_autoDetectFloppyFormat && selectedFileSystem() == best->m_fileSystem)
+	{
+		updatePreview();
+	}
+}
+
+
+//-------------------------------------------------
+//  takeAutoDetectImage
+//-------------------------------------------------
+
+Floptool::Image::ptr IdentifyDialog::takeAutoDetectImage(const Floptool::FloppyFormat &floppyFormat, const Floptool::FileSystem &fileSystem)
+{
+	return m_autoDetectImage && &m_autoDetectImage->floppyFormat() == &floppyFormat && &m_autoDetectImage->fileSystem() == &fileSystem
+		? std::move(m_autoDetectImage)
+		: Floptool::Image::ptr();
+}
+
+
+//-------------------------------------------------
+//  selectedFloppyFormat
+//-------------------------------------------------
+
+const Floptool::FloppyFormat *IdentifyDialog::selectedFloppyFormat() const
+{
+	IdentifyResultsListModel &identifyResultsModel = *dynamic_cast<IdentifyResultsListModel *>(m_ui->identifyResultsTreeView->model());
+	QModelIndexList selectedIndexes = m_ui->identifyResultsTreeView->selectionModel()->selectedIndexes();
+	const Floptool::IdentifyResult *identifyResult = !selectedIndexes.empty()
+		? identifyResultsModel.getItem(selectedIndexes[0])
+		: nullptr;
+	return identifyResult ? &std::get<1>(*identifyResult).get() : nullptr;
+}
+
+
+//-------------------------------------------------
+//  selectedFileSystem
+//-------------------------------------------------
+
+const Floptool::FileSystem *IdentifyDialog::selectedFileSystem() const
+{
+	FileSystemsListModel &fileSystemsModel = *dynamic_cast<FileSystemsListModel *>(m_ui->fileSystemsTreeView->model());
+	QModelIndexList selectedIndexes = m_ui->fileSystemsTreeView->selectionModel()->selectedIndexes();
+	return !selectedIndexes.empty()
+		? fileSystemsModel.getItem(selectedIndexes[0])
+		: nullptr;
+}
+
+
+//-------------------------------------------------
+//  updatePreview
+//-------------------------------------------------
+
+void IdentifyDialog::updatePreview()
+{
+	IdentifyResultsListModel &identifyResultsModel = *dynamic_cast<IdentifyResultsListModel *>(m_ui->identifyResultsTreeView->model());
+	FileSystemsListModel &fileSystemsModel = *dynamic_cast<FileSystemsListModel *>(m_ui->fileSystemsTreeView->model());
+
+	QModelIndexList identifyResultsSelectedIndexes = m_ui->identifyResultsTreeView->selectionModel()->selectedIndexes();
+	QModelIndexList fileSystemsSelectedIndexes = m_ui->fileSystemsTreeView->selectionModel()->selectedIndexes();
+	const Floptool::IdentifyResult *identifyResult = !identifyResultsSelectedIndexes.empty()
+		? identifyResultsModel.getItem(identifyResultsSelectedIndexes[0])
+		: nullptr;
+	const Floptool::FileSystem *fileSystem = !fileSystemsSelectedIndexes.empty()
+		? fileSystemsModel.getItem(fileSystemsSelectedIndexes[0])
+		: nullptr;
+
+	// whatever we were mounting before is no longer interesting; MAME cannot be interrupted
+	// mid-load, but the job will bail out at the next opportunity and its result is ignored
+	m_mountFuture.cancel();
+	m_mountFuture = QFuture<Floptool::Image::ptr>();
+
+	if (!identifyResult || !fileSystem)
+	{
+		setPreviewModel(nullptr);
+		return;
+	}
+
+	// auto-detection may have already mounted exactly this
+	const Floptool::FloppyFormat &floppyFormat = std::get<1>(*identifyResult);
+	Floptool::Image::ptr autoDetectImage = takeAutoDetectImage(floppyFormat, *fileSystem);
+	if (autoDetectImage)
+	{
+		setPreviewModel(new ImageItemModel(std::move(autoDetectImage), this));
+		return;
+	}
+
+	// show a placeholder while we work
+	setPreviewModel(new QStringListModel({ tr("Loading...") }, this));
+
+	// use a speculative mount if we have one, otherwise start mounting
+	std::optional<QFuture<Floptool::Image::ptr>> speculativeMount = takeSpeculativeMount(floppyFormat, *fileSystem);
+	m_mountFuture = speculativeMount
+		? std::move(*speculativeMount)
+		: startMount(m_mountThreadPool, floppyFormat, *fileSystem);
+	m_mountWatcher.setFuture(m_mountFuture);
+
+	// the speculative mount may have already completed
+	if (m_mountFuture.isFinished())
+		mountFinished();
+}
+
+
+//-------------------------------------------------
+//  mountProgressChanged
+//-------------------------------------------------
+
+void IdentifyDialog::mountProgressChanged(int progressValue)
+{
+	QStringListModel *placeholderModel = dynamic_cast<QStringListModel *>(m_ui->previewTreeView->model());
+	if (placeholderModel && progressValue > 0)
+		placeholderModel->setStringList({ tr("Mounting...") });
+}
+
+
+//-------------------------------------------------
+//  mountFinished
+//-------------------------------------------------
+
+void IdentifyDialog::mountFinished()
+{
+	// ignore notifications for stale jobs, and for jobs we already harvested
+	if (!m_mountFuture.isValid() || !m_mountFuture.isFinished() || m_mountFuture.isCanceled())
+		return;
+
+	Floptool::Image::ptr image = m_mountFuture.resultCount() > 0
+		? m_mountFuture.takeResult()
+		: Floptool::Image::ptr();
+	m_mountFuture = QFuture<Floptool::Image::ptr>();
+
+	// set up a preview model
+	setPreviewModel(image
+		? new ImageItemModel(std::move(image), this)
+		: nullptr);
+}
+
+
+//-------------------------------------------------
+//  setPreviewModel
+//-------------------------------------------------
+
+void IdentifyDialog::setPreviewModel(QAbstractItemModel *model)
+{
+	// delete the old model, if necessary
+	QAbstractItemModel *oldModel = m_ui->previewTreeView->model();
+	m_ui->previewTreeView->setModel(model);
+	if (oldModel)
+		delete oldModel;
+}
+
+
+//-------------------------------------------------
+//  detachImage
+//-------------------------------------------------
+
+Floptool::Image::ptr IdentifyDialog::detachImage()
+{
+	// if the user accepted the dialog while we were still mounting, finish the job
+	if (m_mountFuture.isValid())
+	{
+		m_mountFuture.waitForFinished();
+		mountFinished();
+	}
+
+	ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->previewTreeView->model());
+	return model ? model->detachImage() : nullptr;
+}
+
+
+//-------------------------------------------------
+//  CategoryItemListModel ctor
+//-------------------------------------------------
+
+template<class T>
+CategoryItemListModel<T>::CategoryItemListModel(const std::vector<Floptool::Category<T>> &items, QObject *parent)
+	: QAbstractItemModel(parent)
+	, m_items(items)
+{
+}
+
+
+//-------------------------------------------------
+//  CategoryItemListModel::findFirstModelIndexForCategory
+//-------------------------------------------------
+
+template<class T>
+QModelIndex CategoryItemListModel<T>::findFirstModelIndexForCategory(const QString *categoryName) const
+{
+	for (int row = 0; row < m_items.size(); row++)
+	{
+		if (!categoryName || m_items[row].categoryName() == *categoryName)
+		{
+			QModelIndex parentIndex = index(row, 0);
+			return index(0, 0, parentIndex);
+		}
+	}
+	return QModelIndex();
+}
+
+
+//-------------------------------------------------
+//  CategoryItemListModel::findModelIndex
+//-------------------------------------------------
+
+template<class T>
+QModelIndex CategoryItemListModel<T>::findModelIndex(const T &item) const
+{
+	for (int categoryRow = 0; categoryRow < m_items.size(); categoryRow++)
+	{
+		for (int row = 0; row < m_items[categoryRow].size(); row++)
+		{
+			if (&m_items[categoryRow][row] == &item)
+				return index(row, 0, index(categoryRow, 0));
+		}
+	}
+	return QModelIndex();
+}
+
+
+//-------------------------------------------------
+//  CategoryItemListModel::getItem
+//-------------------------------------------------
+
+template<class T>
+const T *CategoryItemListModel<T>::getItem(const QModelIndex &index) const
+{
+	return index.internalId() != ~0
+		? &m_items[index.internalId()][index.row()]
+		: nullptr;
+}
+
+
+//-------------------------------------------------
+//  CategoryItemListModel::index
+//-------------------------------------------------
+
+template<class T>
+QModelIndex CategoryItemListModel<T>::index(int row, int column, const QModelIndex &parent) const
+{
+	QModelIndex result = createIndex(row, column, parent.isValid() ? parent.row() : ~0);
+	assert(result.isValid());
+	return result;
+}
+
+
+//-------------------------------------------------
+//  CategoryItemListModel::parent
+//-------------------------------------------------
+
+template<class T>
+QModelIndex CategoryItemListModel<T>::parent(const QModelIndex &child) const
+{
+	return child.internalId() != ~0
+		? index(child.internalId(), child.column())
+		: QModelIndex();
+}
+
+
+//-------------------------------------------------
+//  CategoryItemListModel::rowCount
+//-------------------------------------------------
+
+template<class T>
+int CategoryItemListModel<T>::rowCount(const QModelIndex &parent) const
+{
+	int result;
+	if (parent.isValid())
+	{
+		// filesystem entry
+		result = m_items[parent.row()].size();
+	}
+	else
+	{
+		// filesystem category
+		result = m_items.size();
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  CategoryItemListModel::columnCount
+//-------------------------------------------------
+
+template<class T>
+int CategoryItemListModel<T>::columnCount(const QModelIndex &parent) const
+{
+	return 1;
+}
+
+
+//-------------------------------------------------
+//  CategoryItemListModel::hasChildren
+//-------------------------------------------------
+
+template<class T>
+bool CategoryItemListModel<T>::hasChildren(const QModelIndex &parent) const
+{
+	return !parent.isValid() || parent.internalId() == ~0;
+}
+
+
+//-------------------------------------------------
+//  CategoryItemListModel::flags
+//-------------------------------------------------
+
+template<class T>
+Qt::ItemFlags CategoryItemListModel<T>::flags(const QModelIndex &index) const
+{
+	bool isEnabled = index.internalId() != ~0
+		? itemEnabled(m_items[index.internalId()][index.row()])
+		: true;
+
+	Qt::ItemFlags result = isEnabled ? Qt::ItemIsEnabled : (Qt::ItemFlags)0;
+	if (index.internalId() != ~0)
+		result |= Qt::ItemIsSelectable | Qt::ItemNeverHasChildren;
+	return result;
+}
+
+
+//-------------------------------------------------
+//  CategoryItemListModel::data
+//-------------------------------------------------
+
+template<class T>
+QVariant CategoryItemListModel<T>::data(const QModelIndex &index, int role) const
+{
+	QVariant result;
+	const T *item = getItem(index);
+	if (item)
+	{
+		// item entry
+		switch (role)
+		{
+		case Qt::DisplayRole:
+			result = displayData(*item);
+			break;
+		}
+	}
+	else
+	{
+		// item category
+		switch (role)
+		{
+		case Qt::DisplayRole:
+			result = m_items[index.row()].categoryName();
+			break;
+
+		case Qt::FontRole:
+			{
+				QFont font;
+				font.setUnderline(true);
+				result = std::move(font);
+			}
+			break;
+		}
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  IdentifyResultsListModel::displayData
+//-------------------------------------------------
+
+QString IdentifyResultsListModel::displayData(const Floptool::IdentifyResult &item) const
+{
+	const Floptool::FloppyFormat &floppyFormat = std::get<1>(item);
+	return floppyFormat.description();
+}
+
+
+//-------------------------------------------------
+//  FileSystemsListModel::itemEnabled
+//-------------------------------------------------
+
+bool IdentifyResultsListModel::itemEnabled(const Floptool::IdentifyResult &item) const
+{
+	return true;
+}
+
+
+//-------------------------------------------------
+//  FileSystemsListModel::displayData
+//-------------------------------------------------
+
+QString FileSystemsListModel::displayData(const Floptool::FileSystem &item) const
+{
+	return item.description();
+}
+
+
+//-------------------------------------------------
+//  FileSystemsListModel::itemEnabled
+//-------------------------------------------------
+
+bool FileSystemsListModel::itemEnabled(const Floptool::FileSystem &item) const
+{
+	return item.canRead();
+}
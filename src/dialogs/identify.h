@@ -1,45 +1,85 @@
-/***************************************************************************
-
-	identify.h
-
-	Image identification dialog
-
-***************************************************************************/
-
-#ifndef IDENTIFY_H
-#define IDENTIFY_H
-
-// qfloptool includes
-#include "../floptool.h"
-
-// Qt includes
-#include <QDialog>
-
-
-QT_BEGIN_NAMESPACE
-namespace Ui { class IdentifyDialog; }
-QT_END_NAMESPACE
-
-// ======================> IdentifyDialog
-
-class IdentifyDialog : public QDialog
-{
-	Q_OBJECT
-
-public:
-	// ctor/dtor
-	IdentifyDialog(QIODevice &file, const std::vector<Floptool::IdentifyResultCategory> &ident, QWidget *parent = nullptr);
-	~IdentifyDialog();
-
-	// methods
-	Floptool::Image::ptr detachImage();
-
-private:
-	std::unique_ptr<Ui::IdentifyDialog>						m_ui;
-	QIODevice &												m_file;
-	const std::vector<Floptool::IdentifyResultCategory> &	m_ident;
-
-	void updatePreview();
-};
-
-#endif // IDENTIFY_H
+/***************************************************************************
+
+	identify.h
+
+	Image identification dialog
+
+***************************************************************************/
+
+#ifndef IDENTIFY_H
+#define IDENTIFY_H
+
+// qfloptool includes
+#include "../decodedimagecache.h"
+#include "../filesystemdetector.h"
+#include "../floptool.h"
+
+// Qt includes
+#include <QDialog>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QThreadPool>
+
+// C++ includes
+#include <optional>
+
+
+QT_BEGIN_NAMESPACE
+namespace Ui { class IdentifyDialog; }
+QT_END_NAMESPACE
+
+// ======================> IdentifyDialog
+
+class IdentifyDialog : public QDialog
+{
+	Q_OBJECT
+
+public:
+	// ctor/dtor
+	IdentifyDialog(MappedFile::ptr &&file, const std::vector<Floptool::IdentifyResultCategory> &ident, QWidget *parent = nullptr);
+	~IdentifyDialog();
+
+	// methods
+	Floptool::Image::ptr detachImage();
+
+private:
+	struct SpeculativeMount
+	{
+		const Floptool::FloppyFormat *		m_floppyFormat;
+		const Floptool::FileSystem *		m_fileSystem;
+		QFuture<Floptool::Image::ptr>		m_future;
+	};
+
+	std::unique_ptr<Ui::IdentifyDialog>						m_ui;
+	MappedFile::ptr											m_file;
+	const std::vector<Floptool::IdentifyResultCategory> &	m_ident;
+	DecodedImageCache										m_decodedImageCache;
+	QThreadPool												m_mountThreadPool;
+	QFuture<Floptool::Image::ptr>							m_mountFuture;
+	QFutureWatcher<Floptool::Image::ptr>					m_mountWatcher;
+	QThreadPool												m_speculativeThreadPool;
+	std::vector<SpeculativeMount>							m_speculativeMounts;
+	QFuture<std::vector<FileSystemDetector::Attempt>>		m_autoDetectFuture;
+	QFutureWatcher<std::vector<FileSystemDetector::Attempt>>	m_autoDetectWatcher;
+	const Floptool::FloppyFormat *							m_autoDetectFloppyFormat;
+	Floptool::Image::ptr									m_autoDetectImage;
+	bool													m_fileSystemChosenByUser;
+	bool													m_selectingFileSystem;
+
+	QFuture<Floptool::Image::ptr> startMount(QThreadPool &threadPool, const Floptool::FloppyFormat &floppyFormat, const Floptool::FileSystem &fileSystem);
+	void startSpeculativeMounts();
+	std::optional<QFuture<Floptool::Image::ptr>> takeSpeculativeMount(const Floptool::FloppyFormat &floppyFormat, const Floptool::FileSystem &fileSystem);
+	void retargetSpeculativeMounts(const Floptool::FloppyFormat &floppyFormat, const Floptool::FileSystem &fileSystem);
+	void cancelSpeculativeMounts();
+	void startAutoDetect();
+	void autoDetectFinished();
+	Floptool::Image::ptr takeAutoDetectImage(const Floptool::FloppyFormat &floppyFormat, const Floptool::FileSystem &fileSystem);
+	const Floptool::FloppyFormat *selectedFloppyFormat() const;
+	const Floptool::FileSystem *selectedFileSystem() const;
+	void updatePreview();
+	void mountProgressChanged(int progressValue);
+	void mountFinished();
+	void setPreviewModel(QAbstractItemModel *model);
+};
+
+#endif // IDENTIFY_H
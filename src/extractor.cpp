@@ -0,0 +1,381 @@
+/***************************************************************************
+
+	extractor.cpp
+
+	Extracts files and directories off of an image in the background
+
+***************************************************************************/
+
+// qfloptool headers
+#include "extractor.h"
+
+// MAME headers
+#include "formats/fsmgr.h"
+
+// Qt headers
+#include <QDir>
+#include <QFile>
+#include <QtConcurrent>
+
+// C++ headers
+#include <algorithm>
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+// host disks (especially network shares) are slow in ways that reading the image is
+// not, so a few writers can be busy at once; this caps how much they can fall behind
+static const int s_writerThreadCount = 4;
+static const int s_archiveWriterThreadCount = 1;
+static const uint64_t s_maximumBytesInFlight = 64 * 1024 * 1024;
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+Extractor::Extractor(const Floptool::Image &image)
+	: m_image(image)
+	, m_isScanning(true)
+	, m_fileCount(0)
+	, m_totalFileCount(0)
+	, m_byteCount(0)
+	, m_totalByteCount(0)
+	, m_errorCount(0)
+	, m_bytesInFlight(0)
+{
+	m_writerPool.setMaxThreadCount(s_writerThreadCount);
+
+	// the worker gets a file system instance of its own, so that the GUI thread can keep
+	// using the primary one in the meantime
+	try
+	{
+		m_fileSystem = m_image.createSnapshot();
+	}
+	catch (...)
+	{
+	}
+}
+
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+Extractor::Extractor(const Floptool::Image &image, ArchiveWriter::ptr &&archiveWriter)
+	: Extractor(image)
+{
+	// an archive is a single stream, so it gets a single writer; that keeps entries in
+	// order while still overlapping compression with reading the image
+	m_archiveWriter = std::move(archiveWriter);
+	m_writerPool.setMaxThreadCount(s_archiveWriterThreadCount);
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+Extractor::~Extractor()
+{
+	cancel();
+	m_future.waitForFinished();
+}
+
+
+//-------------------------------------------------
+//  add
+//-------------------------------------------------
+
+void Extractor::add(std::vector<std::string> &&pathOnImage, QString &&destination)
+{
+	m_items.push_back({ std::move(pathOnImage), std::move(destination) });
+}
+
+
+//-------------------------------------------------
+//  start
+//-------------------------------------------------
+
+QFuture<void> Extractor::start()
+{
+	m_future = QtConcurrent::run([this](QPromise<void> &promise)
+	{
+		run(promise);
+	});
+	return m_future;
+}
+
+
+//-------------------------------------------------
+//  cancel
+//-------------------------------------------------
+
+void Extractor::cancel()
+{
+	m_future.cancel();
+}
+
+
+//-------------------------------------------------
+//  progress
+//-------------------------------------------------
+
+Extractor::Progress Extractor::progress() const
+{
+	Progress result;
+	result.m_isScanning = m_isScanning;
+	result.m_fileCount = m_fileCount;
+	result.m_totalFileCount = m_totalFileCount;
+	result.m_byteCount = m_byteCount;
+	result.m_totalByteCount = m_totalByteCount;
+	result.m_errorCount = m_errorCount;
+	return result;
+}
+
+
+//-------------------------------------------------
+//  run
+//-------------------------------------------------
+
+void Extractor::run(QPromise<void> &promise)
+{
+	if (!m_fileSystem)
+	{
+		m_errorCount++;
+		m_isScanning = false;
+		return;
+	}
+
+	// figure out everything there is to do up front, so that progress can be measured
+	std::vector<Task> tasks = scan(promise);
+	m_isScanning = false;
+
+	// extracting directories is likely to touch most of the image
+	if (std::ranges::any_of(tasks, [](const Task &task) { return task.m_isDirectory; }))
+		m_image.preload();
+
+	// we read files off of the image one at a time (the file system is ours alone), and
+	// hand them off to the writers; the two stages overlap, so the whole thing goes as
+	// fast as the slower of the two rather than at the sum of both
+	for (const Task &task : tasks)
+	{
+		if (promise.isCanceled())
+			break;
+
+		if (task.m_isDirectory)
+		{
+			if (m_archiveWriter)
+			{
+				// archive entries have to go through the writer in order; the root of
+				// the image has no entry of its own
+				if (!task.m_destination.isEmpty())
+				{
+					m_writerPool.start([this, destination = task.m_destination, modified = task.m_modified]()
+					{
+						if (!m_archiveWriter->addDirectory(destination, modified))
+							m_errorCount++;
+					});
+				}
+			}
+			else
+			{
+				// directories are created right here, before anything that goes in them
+				// is handed off
+				if (!QDir(task.m_destination).exists() && !QDir().mkdir(task.m_destination))
+					m_errorCount++;
+			}
+			continue;
+		}
+
+		std::optional<std::vector<uint8_t>> bytes;
+		try
+		{
+			bytes = Floptool::Image::readFile(*m_fileSystem, task.m_pathOnImage);
+		}
+		catch (...)
+		{
+			// MAME file system code can throw on corrupt images
+		}
+		if (!bytes)
+		{
+			m_errorCount++;
+			m_fileCount++;
+			m_byteCount += task.m_length;
+			continue;
+		}
+
+		// wait for the writers to make room; a file bigger than the cap goes through
+		// on its own
+		uint64_t size = bytes->size();
+		{
+			std::unique_lock lock(m_bytesInFlightMutex);
+			while (m_bytesInFlight > 0 && m_bytesInFlight + size > s_maximumBytesInFlight && !promise.isCanceled())
+				m_bytesInFlightCondition.wait_for(lock, std::chrono::milliseconds(100));
+			m_bytesInFlight += size;
+		}
+
+		auto buffer = std::make_shared<std::vector<uint8_t>>(std::move(*bytes));
+		m_writerPool.start([this, buffer, destination = task.m_destination, length = task.m_length, modified = task.m_modified]()
+		{
+			bool success = m_archiveWriter
+				? m_archiveWriter->addFile(destination, *buffer, modified)
+				: writeFile(destination, *buffer);
+			if (!success)
+				m_errorCount++;
+			m_fileCount++;
+			m_byteCount += length;
+
+			std::lock_guard lock(m_bytesInFlightMutex);
+			m_bytesInFlight -= buffer->size();
+			m_bytesInFlightCondition.notify_all();
+		});
+	}
+
+	// writes that were handed off are finished even when cancelled; they are already paid for
+	m_writerPool.waitForDone();
+
+	// and so an archive is closed off properly either way, leaving whatever made it in
+	// readable
+	if (m_archiveWriter && !m_archiveWriter->finish())
+		m_errorCount++;
+}
+
+
+//-------------------------------------------------
+//  scan
+//-------------------------------------------------
+
+std::vector<Extractor::Task> Extractor::scan(QPromise<void> &promise)
+{
+	std::vector<Task> result;
+
+	// find out what each item is by looking it up in its parent directory; the root is
+	// always a directory
+	for (Item &item : m_items)
+	{
+		if (item.m_pathOnImage.empty())
+		{
+			result.push_back({ std::move(item.m_pathOnImage), std::move(item.m_destination), true, 0, std::nullopt });
+			continue;
+		}
+
+		std::optional<std::vector<fs::dir_entry>> entries;
+		try
+		{
+			std::vector<std::string> parentPath(item.m_pathOnImage.begin(), item.m_pathOnImage.end() - 1);
+			entries = Floptool::Image::directoryContents(*m_fileSystem, parentPath);
+		}
+		catch (...)
+		{
+		}
+
+		const fs::dir_entry *entry = nullptr;
+		if (entries)
+		{
+			auto iter = std::ranges::find_if(*entries, [&item](const fs::dir_entry &candidate)
+			{
+				return candidate.m_name == item.m_pathOnImage.back();
+			});
+			if (iter != entries->end())
+				entry = &*iter;
+		}
+		if (!entry)
+		{
+			m_errorCount++;
+			continue;
+		}
+
+		result.push_back(makeTask(std::move(item.m_pathOnImage), std::move(item.m_destination), *entry));
+	}
+
+	// and then walk the directories; parents always come before their children, so by
+	// the time we get to a file its directory will have been created
+	for (std::size_t i = 0; i < result.size() && !promise.isCanceled(); i++)
+	{
+		if (!result[i].m_isDirectory)
+			continue;
+
+		std::optional<std::vector<fs::dir_entry>> entries;
+		try
+		{
+			entries = Floptool::Image::directoryContents(*m_fileSystem, result[i].m_pathOnImage);
+		}
+		catch (...)
+		{
+		}
+		if (!entries)
+		{
+			m_errorCount++;
+			continue;
+		}
+
+		for (const fs::dir_entry &entry : *entries)
+		{
+			std::vector<std::string> pathOnImage = result[i].m_pathOnImage;
+			pathOnImage.push_back(entry.m_name);
+
+			// the root of the image goes at the top of an archive
+			QString destination = m_image.convert(entry.m_name);
+			if (!result[i].m_destination.isEmpty())
+				destination = result[i].m_destination + "/" + destination;
+
+			result.push_back(makeTask(std::move(pathOnImage), std::move(destination), entry));
+		}
+	}
+
+	for (const Task &task : result)
+	{
+		if (!task.m_isDirectory)
+		{
+			m_totalFileCount++;
+			m_totalByteCount += task.m_length;
+		}
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  makeTask
+//-------------------------------------------------
+
+Extractor::Task Extractor::makeTask(std::vector<std::string> &&pathOnImage, QString &&destination, const fs::dir_entry &entry) const
+{
+	Task result;
+	result.m_pathOnImage = std::move(pathOnImage);
+	result.m_destination = std::move(destination);
+	result.m_isDirectory = entry.m_type == fs::dir_entry_type::dir;
+	result.m_length = result.m_isDirectory ? 0 : entry.m_meta.get_number(fs::meta_name::length);
+
+	// modification dates only matter to archives; they are wall clock times with no
+	// time zone, same as the image item model treats them
+	if (m_archiveWriter
+		&& entry.m_meta.has(fs::meta_name::modification_date)
+		&& entry.m_meta.get(fs::meta_name::modification_date).type() == fs::meta_type::date)
+	{
+		util::arbitrary_datetime date = entry.m_meta.get(fs::meta_name::modification_date).as_date();
+		QDateTime dateTime(QDate(date.year, date.month, date.day_of_month), QTime(date.hour, date.minute, date.second), Qt::UTC);
+		if (dateTime.isValid())
+			result.m_modified = std::move(dateTime);
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  writeFile
+//-------------------------------------------------
+
+bool Extractor::writeFile(const QString &destination, const std::vector<uint8_t> &bytes)
+{
+	QFile file(destination);
+	return file.open(QIODevice::WriteOnly)
+		&& file.write((const char *)bytes.data(), bytes.size()) == (qint64)bytes.size();
+}
@@ -0,0 +1,108 @@
+/***************************************************************************
+
+	extractor.h
+
+	Extracts files and directories off of an image in the background
+
+***************************************************************************/
+
+#ifndef EXTRACTOR_H
+#define EXTRACTOR_H
+
+// qfloptool headers
+#include "archivewriter.h"
+#include "floptool.h"
+
+// Qt headers
+#include <QDateTime>
+#include <QFuture>
+#include <QPromise>
+#include <QString>
+#include <QThreadPool>
+
+// C++ headers
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> Extractor
+
+class Extractor
+{
+public:
+	struct Progress
+	{
+		bool		m_isScanning;
+		int			m_fileCount;
+		int			m_totalFileCount;
+		uint64_t	m_byteCount;
+		uint64_t	m_totalByteCount;
+		int			m_errorCount;
+	};
+
+	// ctor/dtor
+	Extractor(const Floptool::Image &image);
+	Extractor(const Floptool::Image &image, ArchiveWriter::ptr &&archiveWriter);
+	Extractor(const Extractor &) = delete;
+	Extractor(Extractor &&) = delete;
+	~Extractor();
+
+	// methods
+	void add(std::vector<std::string> &&pathOnImage, QString &&destination);
+	QFuture<void> start();
+	void cancel();
+	Progress progress() const;
+
+private:
+	struct Item
+	{
+		std::vector<std::string>	m_pathOnImage;
+		QString						m_destination;
+	};
+
+	struct Task
+	{
+		std::vector<std::string>	m_pathOnImage;
+		QString						m_destination;
+		bool						m_isDirectory;
+		uint64_t					m_length;
+		std::optional<QDateTime>	m_modified;
+	};
+
+	const Floptool::Image &				m_image;
+	std::unique_ptr<fs::filesystem_t>	m_fileSystem;		// snapshot; only touched by the worker
+	ArchiveWriter::ptr					m_archiveWriter;	// when extracting to an archive rather than the host
+	std::vector<Item>					m_items;
+	QFuture<void>						m_future;
+
+	// progress, as seen from any thread
+	std::atomic<bool>					m_isScanning;
+	std::atomic<int>					m_fileCount;
+	std::atomic<int>					m_totalFileCount;
+	std::atomic<uint64_t>				m_byteCount;
+	std::atomic<uint64_t>				m_totalByteCount;
+	std::atomic<int>					m_errorCount;
+
+	// writers, and the file contents waiting on them
+	QThreadPool							m_writerPool;
+	std::mutex							m_bytesInFlightMutex;
+	std::condition_variable				m_bytesInFlightCondition;
+	uint64_t							m_bytesInFlight;
+
+	void run(QPromise<void> &promise);
+	std::vector<Task> scan(QPromise<void> &promise);
+	Task makeTask(std::vector<std::string> &&pathOnImage, QString &&destination, const fs::dir_entry &entry) const;
+	static bool writeFile(const QString &destination, const std::vector<uint8_t> &bytes);
+};
+
+
+#endif // EXTRACTOR_H
@@ -0,0 +1,179 @@
+/***************************************************************************
+
+	filesystemdetector.cpp
+
+	Picks the file system of an image by trying all plausible candidates
+
+***************************************************************************/
+
+// qfloptool headers
+#include "filesystemdetector.h"
+
+// MAME headers
+#include "formats/fsmgr.h"
+
+// Qt headers
+#include <QElapsedTimer>
+#include <QtConcurrent>
+
+// C++ headers
+#include <algorithm>
+#include <mutex>
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+// file lengths beyond this are surely garbage on a floppy
+static const std::uint64_t s_implausibleFileLength = 64 * 1024 * 1024;
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  isSaneEntry
+//-------------------------------------------------
+
+static bool isSaneEntry(const fs::dir_entry &entry)
+{
+	// names have to be non-empty and printable
+	if (entry.m_name.empty())
+		return false;
+	bool isPrintable = std::ranges::all_of(entry.m_name, [](char ch)
+	{
+		return (unsigned char)ch >= 0x20 && ch != 0x7F;
+	});
+	if (!isPrintable)
+		return false;
+
+	// and any length we are told has to be believable
+	if (entry.m_type == fs::dir_entry_type::file && entry.m_meta.has(fs::meta_name::length))
+	{
+		if (entry.m_meta.get_number(fs::meta_name::length) > s_implausibleFileLength)
+			return false;
+	}
+	return true;
+}
+
+
+//-------------------------------------------------
+//  candidates
+//-------------------------------------------------
+
+std::vector<const Floptool::FileSystem *> FileSystemDetector::candidates(const Floptool::FloppyFormat &floppyFormat)
+{
+	// the readable file systems that belong with this floppy format
+	const Floptool &floptool = Floptool::instance();
+	const Floptool::Category<Floptool::FloppyFormat> *floppyFormatCategory = floptool.findFloppyFormatCategory(floppyFormat);
+
+	// file systems share category names with the formats used on the same systems; if
+	// there is no such category, every readable file system is fair game
+	bool hasMatchingCategory = floppyFormatCategory && std::ranges::any_of(floptool.fileSystems(), [floppyFormatCategory](const Floptool::Category<Floptool::FileSystem> &category)
+	{
+		return category.categoryName() == floppyFormatCategory->categoryName();
+	});
+
+	std::vector<const Floptool::FileSystem *> result;
+	for (const Floptool::Category<Floptool::FileSystem> &category : floptool.fileSystems())
+	{
+		if (hasMatchingCategory && category.categoryName() != floppyFormatCategory->categoryName())
+			continue;
+		for (const Floptool::FileSystem &fileSystem : category)
+		{
+			if (fileSystem.canRead())
+				result.push_back(&fileSystem);
+		}
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  detect
+//-------------------------------------------------
+
+std::vector<FileSystemDetector::Attempt> FileSystemDetector::detect(const MappedFile::ptr &file, const Floptool::FloppyFormat &floppyFormat, const std::vector<const Floptool::FileSystem *> &candidates, const std::function<Floptool::DecodedImage::ptr()> &decode)
+{
+	// mount the image with all candidates in parallel
+	std::vector<Attempt> result;
+	result.reserve(candidates.size());
+	for (const Floptool::FileSystem *fileSystem : candidates)
+		result.push_back({ fileSystem, Floptool::Image::ptr(), 0, std::chrono::microseconds(0) });
+
+	// plain sector dumps mount straight from the file; the image is only decoded (once)
+	// for the candidates that need it
+	std::once_flag decodeOnce;
+	Floptool::DecodedImage::ptr decodedImage;
+	auto getDecodedImage = [&decodeOnce, &decodedImage, &decode]()
+	{
+		std::call_once(decodeOnce, [&decodedImage, &decode]()
+		{
+			decodedImage = decode();
+		});
+		return decodedImage.get();
+	};
+
+	// mounts share the decoded image's conversion cache, so only the first attempt with a
+	// given converter pays for it
+	QtConcurrent::blockingMap(result, [&file, &floppyFormat, &getDecodedImage](Attempt &attempt)
+	{
+		const Floptool &floptool = Floptool::instance();
+		QElapsedTimer timer;
+		timer.start();
+		try
+		{
+			attempt.m_image = floptool.mountRaw(file, floppyFormat, *attempt.m_fileSystem);
+			if (!attempt.m_image)
+			{
+				const Floptool::DecodedImage *decodedImage = getDecodedImage();
+				if (decodedImage)
+					attempt.m_image = floptool.mount(*decodedImage, *attempt.m_fileSystem);
+			}
+			attempt.m_score = attempt.m_image ? score(*attempt.m_image) : 0;
+		}
+		catch (...)
+		{
+			// MAME file system code can throw on images that are not what it expects
+			attempt.m_image.reset();
+			attempt.m_score = 0;
+		}
+		attempt.m_elapsed = std::chrono::microseconds(timer.nsecsElapsed() / 1000);
+	});
+
+	// best first; ties go to the order of the candidates
+	std::ranges::stable_sort(result, [](const Attempt &a, const Attempt &b)
+	{
+		return a.m_score > b.m_score;
+	});
+	return result;
+}
+
+
+//-------------------------------------------------
+//  score
+//-------------------------------------------------
+
+int FileSystemDetector::score(const Floptool::Image &image)
+{
+	// how plausible does this mounted image look?  zero means not at all
+	auto [err, entries] = image.mameFileSystem().directory_contents(std::vector<std::string>());
+	if (err)
+		return 0;
+
+	// a readable root directory is a start; a non-empty one with sane entries is better
+	int result = 1;
+	if (!entries.empty())
+	{
+		auto saneEntryCount = std::ranges::count_if(entries, isSaneEntry);
+		result += 100;
+		result += (int)(100 * saneEntryCount / entries.size());
+	}
+
+	// a volume name is the cherry on top
+	if (image.volumeName())
+		result += 10;
+	return result;
+}
@@ -0,0 +1,45 @@
+/***************************************************************************
+
+	filesystemdetector.h
+
+	Picks the file system of an image by trying all plausible candidates
+
+***************************************************************************/
+
+#ifndef FILESYSTEMDETECTOR_H
+#define FILESYSTEMDETECTOR_H
+
+// qfloptool headers
+#include "floptool.h"
+
+// C++ headers
+#include <chrono>
+#include <functional>
+#include <vector>
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> FileSystemDetector
+
+class FileSystemDetector
+{
+public:
+	struct Attempt
+	{
+		const Floptool::FileSystem *	m_fileSystem;
+		Floptool::Image::ptr			m_image;		// null if the mount failed
+		int								m_score;		// zero if the mount failed
+		std::chrono::microseconds		m_elapsed;
+	};
+
+	// statics
+	static std::vector<const Floptool::FileSystem *> candidates(const Floptool::FloppyFormat &floppyFormat);
+	static std::vector<Attempt> detect(const MappedFile::ptr &file, const Floptool::FloppyFormat &floppyFormat, const std::vector<const Floptool::FileSystem *> &candidates, const std::function<Floptool::DecodedImage::ptr()> &decode);
+	static int score(const Floptool::Image &image);
+};
+
+
+#endif // FILESYSTEMDETECTOR_H
@@ -1,637 +1,1175 @@
-/***************************************************************************
-
-	floptool.h
-
-	Interface with floptool command line program
-
-***************************************************************************/
-
-// qfloptool headers
-#include "floptool.h"
-#include "utility.h"
-
-// MAME headers
-#include "formats/all.h"
-#include "formats/fsblk_vec.h"
-#include "ioprocs.h"
-#include "ioprocsfill.h"
-#include "ioprocsvec.h"
-
-// Qt headers
-#include <QProcess>
-
-// C++ headers
-#include <algorithm>
-#include <ranges>
-
-
-//**************************************************************************
-//  TYPE DEFINITIONS
-//**************************************************************************
-
-namespace
-{
-	class MameFileSystemFormatEnumeratorImpl : public fs::manager_t::floppy_enumerator
-	{
-	public:
-		struct FileSystemFormat
-		{
-			FileSystemFormat(const floppy_image_format_t &type, uint32_t image_size, const char *name, const char *description);
-
-			const floppy_image_format_t &	m_type;
-			uint32_t						m_imageSize;
-			const char *					m_name;
-			const char *					m_description;
-		};
-
-		// ctor
-		MameFileSystemFormatEnumeratorImpl();
-
-		// accessors
-		const std::vector<FileSystemFormat> &fileSystemFormats() const { return m_fileSystemFormats;  }
-
-		// virtuals
-		virtual void add_raw(const char *name, uint32_t key, const char *description) override final;
-
-	protected:
-		// virtuals
-		virtual void add_format(const floppy_image_format_t &type, uint32_t image_size, const char *name, const char *description) override final;
-
-	private:
-		std::vector<FileSystemFormat>	m_fileSystemFormats;
-		std::vector<uint32_t>			m_variants;
-	};
-};
-
-
-// ======================> MameFormatsEnumeratorImpl
-
-class Floptool::MameFormatsEnumeratorImpl : public mame_formats_enumerator
-{
-public:
-	// ctor
-	MameFormatsEnumeratorImpl(Floptool &host);
-
-	// methods
-	virtual void category(const char *name);
-	virtual void add(const cassette_image::Format *const *formats);
-	virtual void add(const floppy_image_format_t &mameFormat);
-	virtual void add(const fs::manager_t &fs);
-
-private:
-	Floptool &	m_host;
-	QString		m_currentCategory;
-};
-
-
-// ======================> MameRandomRead
-
-class MameRandomRead : public util::random_read
-{
-public:
-	// ctor
-	MameRandomRead(QIODevice &inner);
-
-	// virtuals
-	virtual std::error_condition read(void *buffer, std::size_t length, std::size_t &actual) noexcept;
-	virtual std::error_condition seek(std::int64_t offset, int whence) noexcept;
-	virtual std::error_condition tell(std::uint64_t &result) noexcept;
-	virtual std::error_condition length(std::uint64_t &result) noexcept;
-	virtual std::error_condition read_at(std::uint64_t offset, void *buffer, std::size_t length, std::size_t &actual) noexcept;
-
-private:
-	QIODevice &		m_inner;
-}
-;
-
-
-//**************************************************************************
-//  IMPLEMENTATION
-//**************************************************************************
-
-Floptool *Floptool::s_instance;
-
-
-//-------------------------------------------------
-//  ctor
-//-------------------------------------------------
-
-Floptool::Floptool()
-{
-	assert(!s_instance);
-	s_instance = this;
-}
-
-
-//-------------------------------------------------
-//  dtor
-//-------------------------------------------------
-
-Floptool::~Floptool()
-{
-	assert(s_instance);
-	s_instance = nullptr;
-}
-
-
-//-------------------------------------------------
-//  instance
-//-------------------------------------------------
-
-Floptool &Floptool::instance()
-{
-	assert(s_instance);
-	return *s_instance;
-}
-
-
-//-------------------------------------------------
-//  initializeMameFormats
-//-------------------------------------------------
-
-void Floptool::initializeMameFormats()
-{
-	// clear out our data
-	m_floppyFormats.clear();
-	m_floppyFormats.reserve(256);
-	m_fileSystems.clear();
-	m_fileSystems.reserve(32);
-
-	// get data out of MAME
-	MameFormatsEnumeratorImpl en(*this);
-	mame_formats_full_list(en);
-
-	// shrink to fit
-	m_floppyFormats.shrink_to_fit();
-	m_fileSystems.shrink_to_fit();
-
-	// and sort the data by categories
-	std::ranges::sort(m_floppyFormats, [](const auto &a, const auto &b)
-	{
-		return a.categoryName() < b.categoryName();
-	});
-	std::ranges::sort(m_fileSystems, [](const auto &a, const auto &b)
-	{
-		return a.categoryName() < b.categoryName();
-	});
-}
-
-
-//-------------------------------------------------
-//  identify
-//-------------------------------------------------
-
-std::vector<Floptool::IdentifyResultCategory> Floptool::identify(QIODevice &file) const
-{
-	std::vector<IdentifyResultCategory> resultCategories;
-
-	QString fileExtension = QFileInfo().suffix();
-
-	MameRandomRead randomRead(file);
-	std::vector<uint32_t> variants;
-	for (const auto &floppyFormatCategory : m_floppyFormats)
-	{
-		for (const FloppyFormat &floppyFormat : floppyFormatCategory)
-		{
-			// try to identify the image
-			uint8_t score = floppyFormat.m_mameFormat.identify(randomRead, floppy_image::FF_UNKNOWN, variants);
-			if (score)
-			{
-				// the image was successfully identified - the onus is on us to check the file extension
-				if (std::ranges::find(floppyFormat.fileExtensions(), fileExtension) != floppyFormat.fileExtensions().end())
-					score |= floppy_image_format_t::FIFID_EXT;
-
-				// try to find a result in this category
-				auto iter = std::ranges::find_if(resultCategories, [&floppyFormatCategory](const auto &x)
-				{
-					return x.categoryName() == floppyFormatCategory.categoryName();
-				});
-				
-				auto &resultsCategory = iter != resultCategories.end()
-					? *iter
-					: resultCategories.emplace_back(floppyFormatCategory.categoryName());
-
-				resultsCategory.emplace_back(score, std::reference_wrapper<const FloppyFormat>(floppyFormat));
-			}
-		}
-	}
-
-	// sort the results - this requires two levels of sorts
-	for (IdentifyResultCategory &cat : resultCategories)
-	{
-		std::ranges::sort(cat, [](const auto &x, const auto &y)
-		{
-			return std::get<0>(x) > std::get<0>(y);
-		});
-	}
-	std::ranges::sort(resultCategories, [](const auto &x, const auto &y)
-	{
-		return std::get<0>(x[0]) > std::get<0>(y[0]);
-	});
-
-	return resultCategories;
-}
-
-
-//-------------------------------------------------
-//  findFloppyFormat
-//-------------------------------------------------
-
-const Floptool::FloppyFormat *Floptool::findFloppyFormat(const QString &name) const
-{
-	auto view = std::ranges::join_view(m_floppyFormats);
-	auto iter = std::ranges::find_if(view, [&name](const FloppyFormat &floppyFormat)
-	{
-		return floppyFormat.name() == name;
-	});
-	return iter != view.end() ? &*iter : nullptr;
-}
-
-
-//-------------------------------------------------
-//  findFileSystem
-//-------------------------------------------------
-
-const Floptool::FileSystem *Floptool::findFileSystem(const QString &name) const
-{
-	auto view = std::ranges::join_view(m_fileSystems);
-	auto iter = std::ranges::find_if(view, [&name](const FileSystem &fileSystem)
-	{
-		return fileSystem.name() == name;
-	});
-	return iter != view.end() ? &*iter : nullptr;
-}
-
-
-//-------------------------------------------------
-//  mount
-//-------------------------------------------------
-
-Floptool::Image::ptr Floptool::mount(QIODevice &file, const Floptool::FloppyFormat &format, const Floptool::FileSystem &fileSystem) const
-{
-	MameRandomRead randomRead(file);
-
-	// try to load the image
-	std::vector<uint32_t> variants;
-	floppy_image mameFloppyImage(84, 2, floppy_image::FF_UNKNOWN);
-	if (!format.m_mameFormat.load(randomRead, floppy_image::FF_UNKNOWN, variants, &mameFloppyImage))
-		return {};
-
-	// figure out what file system formats can be used
-	MameFileSystemFormatEnumeratorImpl fsEnum;
-	fileSystem.m_mameFsManager.enumerate_f(fsEnum);
-
-	// convert the image to something more 
-	const floppy_image_format_t *floppyFsConverter = nullptr;
-	std::vector<uint8_t> sectorImage;
-	std::optional<floppy_image> floppyImage;
-	bool success = false;
-	for (const auto &ci : fsEnum.fileSystemFormats())
-	{
-		if (&ci.m_type != floppyFsConverter)
-		{
-			// clear out sectorImage and target it with a stream
-			sectorImage.clear();
-			util::random_read_write_fill_wrapper<util::vector_read_write_adapter<uint8_t>, 0xff> io(sectorImage);
-
-			// and convert to the right format
-			std::vector<uint32_t> variants;
-			floppyFsConverter = &ci.m_type;
-			floppyFsConverter->save(io, variants, &mameFloppyImage);
-		}
-
-		success = ci.m_imageSize == sectorImage.size();
-		if (success)		
-			break;
-	}
-	if (!success)
-		return {};
-
-	return std::make_unique<Image>(format, fileSystem, std::move(sectorImage));
-}
-
-
-//-------------------------------------------------
-//  FloppyFormat ctor
-//-------------------------------------------------
-
-Floptool::FloppyFormat::FloppyFormat(const floppy_image_format_t &mameFormat)
-	: m_mameFormat(mameFormat)
-{
-	// build file extensions
-	const char *extensions = m_mameFormat.extensions();
-	while (extensions && *extensions)
-	{
-		const char *s = strchr(extensions, ',');
-
-		QString ext = QString::fromUtf8(extensions, s ? s - extensions : -1);
-		m_fileExtensions.push_back(std::move(ext));
-
-		extensions = s ? s + 1 : nullptr;
-	}
-	m_fileExtensions.shrink_to_fit();
-}
-
-
-//-------------------------------------------------
-//  FloppyFormat::name
-//-------------------------------------------------
-
-QString Floptool::FloppyFormat::name() const
-{
-	return m_mameFormat.name();
-}
-
-
-//-------------------------------------------------
-//  FloppyFormat::description
-//-------------------------------------------------
-
-QString Floptool::FloppyFormat::description() const
-{
-	return QString::fromUtf8(m_mameFormat.description());
-}
-
-
-//-------------------------------------------------
-//  FileSystem ctor
-//-------------------------------------------------
-
-Floptool::FileSystem::FileSystem(const fs::manager_t &mameFsManager)
-	: m_mameFsManager(mameFsManager)
-{
-}
-
-
-//-------------------------------------------------
-//  FileSystem::name
-//-------------------------------------------------
-
-QString Floptool::FileSystem::name() const
-{
-	return m_mameFsManager.name();
-}
-
-
-//-------------------------------------------------
-//  FileSystem::description
-//-------------------------------------------------
-
-QString Floptool::FileSystem::description() const
-{
-	return QString::fromUtf8(m_mameFsManager.description());
-}
-
-
-//-------------------------------------------------
-//  FileSystem::canRead
-//-------------------------------------------------
-
-bool Floptool::FileSystem::canRead() const
-{
-	return m_mameFsManager.can_read();
-}
-
-
-//-------------------------------------------------
-//  Category ctor
-//-------------------------------------------------
-
-template<class T>
-Floptool::Category<T>::Category(const QString &categoryName)
-	: m_categoryName(categoryName)
-{
-}
-
-
-//-------------------------------------------------
-//  Image ctor
-//-------------------------------------------------
-
-Floptool::Image::Image(const Floptool::FloppyFormat &format, const Floptool::FileSystem &fileSystem, std::vector<uint8_t> &&sectorImage)
-	: m_format(format)
-	, m_fileSystem(fileSystem)
-	, m_sectorImage(std::move(sectorImage))
-{
-	m_mameFsBlk.reset(new fs::fsblk_vec_t(m_sectorImage));
-	m_mameFs = m_fileSystem.m_mameFsManager.mount(*m_mameFsBlk);
-}
-
-
-//-------------------------------------------------
-//  Image dtor
-//-------------------------------------------------
-
-Floptool::Image::~Image()
-{
-}
-
-
-//-------------------------------------------------
-//  Image::convert
-//-------------------------------------------------
-
-QString Floptool::Image::convert(std::string_view s) const
-{
-	return QString::fromLocal8Bit(s);
-}
-
-
-//-------------------------------------------------
-//  Image::volumeName
-//-------------------------------------------------
-
-std::optional<QString> Floptool::Image::volumeName() const
-{
-	fs::meta_data meta = m_mameFs->volume_metadata();
-	std::optional<QString> result;
-	if (meta.has(fs::meta_name::name))
-		result = convert(meta.get(fs::meta_name::name).as_string());
-	return result;	
-}
-
-
-//-------------------------------------------------
-//  Image::readFile
-//-------------------------------------------------
-
-std::optional<std::vector<uint8_t>> Floptool::Image::readFile(const std::vector<std::string> &path) const
-{
-	auto [err, bytes] = mameFileSystem().file_read(path);
-	return err
-		? std::nullopt
-		: std::optional<std::vector<uint8_t>>(std::move(bytes));
-}
-
-
-//-------------------------------------------------
-//  MameFormatsEnumeratorImpl ctor
-//-------------------------------------------------
-
-Floptool::MameFormatsEnumeratorImpl::MameFormatsEnumeratorImpl(Floptool &host)
-	: m_host(host)
-{
-}
-
-
-//-------------------------------------------------
-//  MameFormatsEnumeratorImpl::category
-//-------------------------------------------------
-
-void Floptool::MameFormatsEnumeratorImpl::category(const char *name)
-{
-	m_currentCategory = QString::fromUtf8(name);
-}
-
-
-//-------------------------------------------------
-//  MameFormatsEnumeratorImpl::add(const cassette_image::Format *const *)
-//-------------------------------------------------
-
-void Floptool::MameFormatsEnumeratorImpl::add(const cassette_image::Format *const *formats)
-{
-}
-
-
-//-------------------------------------------------
-//  MameFormatsEnumeratorImpl::add(const floppy_image_format_t &)
-//-------------------------------------------------
-
-void Floptool::MameFormatsEnumeratorImpl::add(const floppy_image_format_t &mameFormat)
-{
-	if (m_host.m_floppyFormats.empty() || util::last(m_host.m_floppyFormats).categoryName() != m_currentCategory)
-		m_host.m_floppyFormats.emplace_back(m_currentCategory);
-	util::last(m_host.m_floppyFormats).emplace_back(mameFormat);
-}
-
-
-//-------------------------------------------------
-//  MameFormatsEnumeratorImpl::add(const fs::manager_t &)
-//-------------------------------------------------
-
-void Floptool::MameFormatsEnumeratorImpl::add(const fs::manager_t &mameFsManager)
-{
-	if (m_host.m_fileSystems.empty() || util::last(m_host.m_fileSystems).categoryName() != m_currentCategory)
-		m_host.m_fileSystems.emplace_back(m_currentCategory);
-	util::last(m_host.m_fileSystems).emplace_back(mameFsManager);
-}
-
-
-//-------------------------------------------------
-//  MameFileSystemFormatEnumeratorImpl ctor
-//-------------------------------------------------
-
-MameFileSystemFormatEnumeratorImpl::MameFileSystemFormatEnumeratorImpl()
-	: fs::manager_t::floppy_enumerator(floppy_image::FF_UNKNOWN, m_variants)
-{
-}
-
-
-//-------------------------------------------------
-//  MameFileSystemFormatEnumeratorImpl::add_raw
-//-------------------------------------------------
-
-void MameFileSystemFormatEnumeratorImpl::add_raw(const char *name, uint32_t key, const char *description)
-{
-}
-
-
-//-------------------------------------------------
-//  MameFileSystemFormatEnumeratorImpl::add_format
-//-------------------------------------------------
-
-void MameFileSystemFormatEnumeratorImpl::add_format(const floppy_image_format_t &type, uint32_t image_size, const char *name, const char *description)
-{
-	m_fileSystemFormats.emplace_back(type, image_size, name, description);
-}
-
-
-//-------------------------------------------------
-//  MameFileSystemFormatEnumeratorImpl::FileSystemFormat ctor
-//-------------------------------------------------
-
-MameFileSystemFormatEnumeratorImpl::FileSystemFormat::FileSystemFormat(const floppy_image_format_t &type, uint32_t image_size, const char *name, const char *description)
-	: m_type(type)
-	, m_imageSize(image_size)
-	, m_name(name)
-	, m_description(description)
-{
-}
-
-
-//-------------------------------------------------
-//  MameRandomRead ctor
-//-------------------------------------------------
-
-MameRandomRead::MameRandomRead(QIODevice &inner)
-	: m_inner(inner)
-{
-}
-
-
-//-------------------------------------------------
-//  MameRandomRead::read
-//-------------------------------------------------
-
-std::error_condition MameRandomRead::read(void *buffer, std::size_t length, std::size_t &actual) noexcept
-{
-	actual = m_inner.read((char *)buffer, length);
-	return std::error_condition();
-}
-
-
-//-------------------------------------------------
-//  MameRandomRead::seek
-//-------------------------------------------------
-
-std::error_condition MameRandomRead::seek(std::int64_t offset, int whence) noexcept
-{
-	switch (whence)
-	{
-	case SEEK_SET:
-		// do nothing
-		break;
-
-	case SEEK_CUR:
-		offset += m_inner.pos();
-		break;
-
-	case SEEK_END:
-		offset += m_inner.size();
-		break;
-	}
-	m_inner.seek(offset);
-	return std::error_condition();
-}
-
-
-//-------------------------------------------------
-//  MameRandomRead::tell
-//-------------------------------------------------
-
-std::error_condition MameRandomRead::tell(std::uint64_t &result) noexcept
-{
-	result = m_inner.pos();;
-	return std::error_condition();
-}
-
-//-------------------------------------------------
-//  MameRandomRead::length
-//-------------------------------------------------
-
-std::error_condition MameRandomRead::length(std::uint64_t &result) noexcept
-{
-	result = m_inner.size();
-	return std::error_condition();
-}
-
-
-//-------------------------------------------------
-//  MameRandomRead::read_at
-//-------------------------------------------------
-
-std::error_condition MameRandomRead::read_at(std::uint64_t offset, void *buffer, std::size_t length, std::size_t &actual) noexcept
-{
-	m_inner.seek(offset);
-	return read(buffer, length, actual);
-}
+/***************************************************************************
+
+	floptool.h
+
+	Interface with floptool command line program
+
+***************************************************************************/
+
+// qfloptool headers
+#include "floptool.h"
+#include "identifycache.h"
+
+// MAME headers
+#include "formats/all.h"
+#include "formats/fsblk_vec.h"
+#include "ioprocs.h"
+#include "ioprocsfill.h"
+#include "ioprocsvec.h"
+
+// Qt headers
+#include <QFileInfo>
+#include <QtConcurrent>
+
+// C++ headers
+#include <algorithm>
+#include <ranges>
+
+
+//**************************************************************************
+//  TYPE DEFINITIONS
+//**************************************************************************
+
+namespace
+{
+	class MameFileSystemFormatEnumeratorImpl : public fs::manager_t::floppy_enumerator
+	{
+	public:
+		struct FileSystemFormat
+		{
+			FileSystemFormat(const floppy_image_format_t &type, uint32_t image_size, const char *name, const char *description);
+
+			const floppy_image_format_t &	m_type;
+			uint32_t						m_imageSize;
+			const char *					m_name;
+			const char *					m_description;
+		};
+
+		// ctor
+		MameFileSystemFormatEnumeratorImpl(uint32_t formFactor = floppy_image::FF_UNKNOWN, uint32_t variant = 0);
+
+		// accessors
+		const std::vector<FileSystemFormat> &fileSystemFormats() const { return m_fileSystemFormats;  }
+
+		// virtuals
+		virtual void add_raw(const char *name, uint32_t key, const char *description) override final;
+
+	protected:
+		// virtuals
+		virtual void add_format(const floppy_image_format_t &type, uint32_t image_size, const char *name, const char *description) override final;
+
+	private:
+		std::vector<FileSystemFormat>	m_fileSystemFormats;
+		std::vector<uint32_t>			m_variants;
+	};
+};
+
+
+// ======================> MameFormatsEnumeratorImpl
+
+class Floptool::MameFormatsEnumeratorImpl : public mame_formats_enumerator
+{
+public:
+	// ctor
+	MameFormatsEnumeratorImpl(Floptool &host);
+
+	// methods
+	virtual void category(const char *name);
+	virtual void add(const cassette_image::Format *const *formats);
+	virtual void add(const floppy_image_format_t &mameFormat);
+	virtual void add(const fs::manager_t &fs);
+
+private:
+	Floptool &	m_host;
+	QString		m_currentCategory;
+};
+
+
+// ======================> MameMappedRead
+
+class MameMappedRead : public util::random_read
+{
+public:
+	// ctor
+	MameMappedRead(const MappedFile &file);
+
+	// virtuals
+	virtual std::error_condition read(void *buffer, std::size_t length, std::size_t &actual) noexcept;
+	virtual std::error_condition seek(std::int64_t offset, int whence) noexcept;
+	virtual std::error_condition tell(std::uint64_t &result) noexcept;
+	virtual std::error_condition length(std::uint64_t &result) noexcept;
+	virtual std::error_condition read_at(std::uint64_t offset, void *buffer, std::size_t length, std::size_t &actual) noexcept;
+
+private:
+	std::span<const uint8_t>	m_bytes;
+	std::uint64_t				m_position;
+};
+
+
+// ======================> MameSectorImageBlockDevice
+
+class MameSectorImageBlockDevice : public fs::fsblk_vec_t
+{
+public:
+	// ctor
+	MameSectorImageBlockDevice(Floptool::SectorImage &&sectorImage);
+
+private:
+	Floptool::SectorImage	m_sectorImage;
+};
+
+
+// ======================> MameMappedBlockDevice
+
+class MameMappedBlockDevice : public fs::fsblk_t
+{
+public:
+	// ctor
+	MameMappedBlockDevice(const MappedFile::ptr &file);
+
+	// virtuals
+	virtual uint32_t block_count() const override;
+	virtual block_t get(uint32_t id) override;
+	virtual void fill(uint8_t data) override;
+
+private:
+	class Block : public iblock_t
+	{
+	public:
+		Block(const uint8_t *data, uint32_t size);
+
+		virtual const uint8_t *rodata() override;
+		virtual uint8_t *data() override;
+
+	private:
+		const uint8_t *	m_data;
+	};
+
+	MappedFile::ptr		m_file;
+};
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+// identify() results can change without the format set changing, when MAME fixes its
+// probes; the MAME version covers releases (when the build knows it), and this covers
+// anything else, and has to be bumped by hand
+#ifndef QFLOPTOOL_MAME_VERSION
+#define QFLOPTOOL_MAME_VERSION 0
+#endif
+static const std::uint32_t s_mameVersion = QFLOPTOOL_MAME_VERSION;
+static const std::uint32_t s_identifyBehaviorVersion = 1;
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+Floptool *Floptool::s_instance;
+
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+Floptool::Floptool()
+	: m_formatSetFingerprint(0)
+{
+	assert(!s_instance);
+	s_instance = this;
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+Floptool::~Floptool()
+{
+	assert(s_instance);
+	s_instance = nullptr;
+}
+
+
+//-------------------------------------------------
+//  instance
+//-------------------------------------------------
+
+Floptool &Floptool::instance()
+{
+	assert(s_instance);
+	return *s_instance;
+}
+
+
+//-------------------------------------------------
+//  initializeMameFormats
+//-------------------------------------------------
+
+void Floptool::initializeMameFormats()
+{
+	// clear out our data
+	m_floppyFormats.clear();
+	m_floppyFormats.reserve(256);
+	m_fileSystems.clear();
+	m_fileSystems.reserve(32);
+	m_identifyPrefilter.clear();
+
+	// get data out of MAME
+	MameFormatsEnumeratorImpl en(*this);
+	mame_formats_full_list(en);
+
+	// shrink to fit
+	m_floppyFormats.shrink_to_fit();
+	m_fileSystems.shrink_to_fit();
+
+	// and sort the data by categories
+	std::ranges::sort(m_floppyFormats, [](const auto &a, const auto &b)
+	{
+		return a.categoryName() < b.categoryName();
+	});
+	std::ranges::sort(m_fileSystems, [](const auto &a, const auto &b)
+	{
+		return a.categoryName() < b.categoryName();
+	});
+
+	// build the identify prefilter, and fingerprint the format set so that cached identify
+	// results are invalidated when the MAME formats change
+	std::uint64_t fingerprint = IdentifyCache::s_hashBasis;
+	auto hashString = [&fingerprint](const char *s)
+	{
+		std::span<const uint8_t> bytes((const uint8_t *)s, s ? strlen(s) + 1 : 0);
+		fingerprint = IdentifyCache::hashBytes(bytes, fingerprint);
+	};
+	auto hashNumber = [&fingerprint](std::uint32_t value)
+	{
+		std::span<const uint8_t> bytes((const uint8_t *)&value, sizeof(value));
+		fingerprint = IdentifyCache::hashBytes(bytes, fingerprint);
+	};
+	hashNumber(s_mameVersion);
+	hashNumber(s_identifyBehaviorVersion);
+	for (const auto &floppyFormatCategory : m_floppyFormats)
+	{
+		for (const FloppyFormat &floppyFormat : floppyFormatCategory)
+		{
+			m_identifyPrefilter.addFormat(floppyFormat.m_mameFormat);
+			hashString(floppyFormat.m_mameFormat.name());
+			hashString(floppyFormat.m_mameFormat.description());
+			hashString(floppyFormat.m_mameFormat.extensions());
+		}
+	}
+	m_formatSetFingerprint = fingerprint;
+}
+
+
+//-------------------------------------------------
+//  enableIdentifyCache
+//-------------------------------------------------
+
+void Floptool::enableIdentifyCache(const QString &fileName)
+{
+	m_identifyCache = std::make_unique<IdentifyCache>(fileName, m_formatSetFingerprint);
+}
+
+
+//-------------------------------------------------
+//  disableIdentifyCache
+//-------------------------------------------------
+
+void Floptool::disableIdentifyCache()
+{
+	m_identifyCache.reset();
+}
+
+
+//-------------------------------------------------
+//  identify
+//-------------------------------------------------
+
+std::vector<Floptool::IdentifyResultCategory> Floptool::identify(QIODevice &file, IdentifyMode mode) const
+{
+	MappedFile::ptr mappedFile = MappedFile::open(file);
+	return identify(*mappedFile, mode);
+}
+
+
+//-------------------------------------------------
+//  identify
+//-------------------------------------------------
+
+std::vector<Floptool::IdentifyResultCategory> Floptool::identify(const MappedFile &file, IdentifyMode mode) const
+{
+	struct Probe
+	{
+		const Category<FloppyFormat> *	m_category;
+		const FloppyFormat *			m_floppyFormat;
+		uint8_t							m_score;
+	};
+
+	QString fileExtension = QFileInfo(file.fileName()).suffix().toLower();
+	std::vector<Probe> probes;
+
+	// consult the identify cache; exhaustive identification always probes, since it is used for validation
+	std::optional<IdentifyCache::Key> cacheKey;
+	bool cacheHit = false;
+	if (m_identifyCache && mode == IdentifyMode::Prefiltered)
+	{
+		cacheKey = IdentifyCache::keyForFile(file);
+		std::optional<std::vector<IdentifyCache::Entry>> cacheEntries = cacheKey
+			? m_identifyCache->find(*cacheKey)
+			: std::nullopt;
+		if (cacheEntries)
+		{
+			cacheHit = true;
+			for (const IdentifyCache::Entry &entry : *cacheEntries)
+			{
+				const FloppyFormat *floppyFormat = findFloppyFormat(entry.m_formatName);
+				const Category<FloppyFormat> *category = floppyFormat ? findFloppyFormatCategory(*floppyFormat) : nullptr;
+				if (!category)
+				{
+					// should not happen given the fingerprint, but if it does we probe
+					cacheHit = false;
+					probes.clear();
+					break;
+				}
+				probes.push_back({ category, floppyFormat, entry.m_score });
+			}
+		}
+	}
+
+	if (!cacheHit)
+	{
+		// build the list of probes, in the order of our format list; unless we were asked to be
+		// exhaustive, formats that the prefilter can rule out are skipped
+		probes.reserve(256);
+		for (const auto &floppyFormatCategory : m_floppyFormats)
+		{
+			for (const FloppyFormat &floppyFormat : floppyFormatCategory)
+			{
+				if (mode == IdentifyMode::Exhaustive || m_identifyPrefilter.isCandidate(floppyFormat.m_mameFormat, file.bytes()))
+					probes.push_back({ &floppyFormatCategory, &floppyFormat, 0 });
+			}
+		}
+
+		// and run them across the thread pool; each probe gets its own reader over the mapped bytes
+		QtConcurrent::blockingMap(probes, [&file](Probe &probe)
+		{
+			MameMappedRead randomRead(file);
+			std::vector<uint32_t> variants;
+			probe.m_score = probe.m_floppyFormat->m_mameFormat.identify(randomRead, floppy_image::FF_UNKNOWN, variants);
+		});
+
+		// record the raw scores; the extension bonus is applied below, since the same
+		// image could be opened under a different name
+		if (cacheKey)
+		{
+			std::vector<IdentifyCache::Entry> cacheEntries;
+			for (const Probe &probe : probes)
+			{
+				if (probe.m_score)
+					cacheEntries.push_back({ probe.m_floppyFormat->name(), probe.m_score });
+			}
+			m_identifyCache->insert(*cacheKey, std::move(cacheEntries));
+		}
+	}
+
+	// merge the results; we walk the probes in order so the output is deterministic
+	std::vector<IdentifyResultCategory> resultCategories;
+	for (const Probe &probe : probes)
+	{
+		uint8_t score = probe.m_score;
+		if (score)
+		{
+			// the image was successfully identified - the onus is on us to check the file extension
+			const FloppyFormat &floppyFormat = *probe.m_floppyFormat;
+			if (std::ranges::find(floppyFormat.fileExtensions(), fileExtension) != floppyFormat.fileExtensions().end())
+				score |= floppy_image_format_t::FIFID_EXT;
+
+			// try to find a result in this category
+			auto iter = std::ranges::find_if(resultCategories, [&probe](const auto &x)
+			{
+				return x.categoryName() == probe.m_category->categoryName();
+			});
+
+			auto &resultsCategory = iter != resultCategories.end()
+				? *iter
+				: resultCategories.emplace_back(probe.m_category->categoryName());
+
+			resultsCategory.emplace_back(score, std::reference_wrapper<const FloppyFormat>(floppyFormat));
+		}
+	}
+
+	// sort the results - this requires two levels of sorts
+	for (IdentifyResultCategory &cat : resultCategories)
+	{
+		std::ranges::stable_sort(cat, [](const auto &x, const auto &y)
+		{
+			return std::get<0>(x) > std::get<0>(y);
+		});
+	}
+	std::ranges::stable_sort(resultCategories, [](const auto &x, const auto &y)
+	{
+		return std::get<0>(x[0]) > std::get<0>(y[0]);
+	});
+
+	return resultCategories;
+}
+
+
+//-------------------------------------------------
+//  findFloppyFormat
+//-------------------------------------------------
+
+const Floptool::FloppyFormat *Floptool::findFloppyFormat(const QString &name) const
+{
+	auto view = std::ranges::join_view(m_floppyFormats);
+	auto iter = std::ranges::find_if(view, [&name](const FloppyFormat &floppyFormat)
+	{
+		return floppyFormat.name() == name;
+	});
+	return iter != view.end() ? &*iter : nullptr;
+}
+
+
+//-------------------------------------------------
+//  findFloppyFormatCategory
+//-------------------------------------------------
+
+const Floptool::Category<Floptool::FloppyFormat> *Floptool::findFloppyFormatCategory(const FloppyFormat &floppyFormat) const
+{
+	auto iter = std::ranges::find_if(m_floppyFormats, [&floppyFormat](const Category<FloppyFormat> &category)
+	{
+		return std::ranges::any_of(category, [&floppyFormat](const FloppyFormat &x) { return &x == &floppyFormat; });
+	});
+	return iter != m_floppyFormats.end() ? &*iter : nullptr;
+}
+
+
+//-------------------------------------------------
+//  findFileSystem
+//-------------------------------------------------
+
+const Floptool::FileSystem *Floptool::findFileSystem(const QString &name) const
+{
+	auto view = std::ranges::join_view(m_fileSystems);
+	auto iter = std::ranges::find_if(view, [&name](const FileSystem &fileSystem)
+	{
+		return fileSystem.name() == name;
+	});
+	return iter != view.end() ? &*iter : nullptr;
+}
+
+
+//-------------------------------------------------
+//  createRawBlockDevice
+//-------------------------------------------------
+
+static std::unique_ptr<fs::fsblk_t> createRawBlockDevice(const MappedFile::ptr &file, const floppy_image_format_t &sourceFormat, const std::vector<MameFileSystemFormatEnumeratorImpl::FileSystemFormat> &fileSystemFormats)
+{
+	// if the file system lists the source format itself as a converter, and the file has
+	// exactly the expected size, then the file already is the sector image we would get by
+	// running load() and save(); so we can skip both and use the file's bytes directly
+	auto iter = std::ranges::find_if(fileSystemFormats, [&file, &sourceFormat](const auto &ci)
+	{
+		return &ci.m_type == &sourceFormat && ci.m_imageSize == file->size();
+	});
+	return iter != fileSystemFormats.end()
+		? std::make_unique<MameMappedBlockDevice>(file)
+		: std::unique_ptr<fs::fsblk_t>();
+}
+
+
+//-------------------------------------------------
+//  mount
+//-------------------------------------------------
+
+Floptool::Image::ptr Floptool::mount(QIODevice &file, const Floptool::FloppyFormat &format, const Floptool::FileSystem &fileSystem) const
+{
+	MappedFile::ptr mappedFile = MappedFile::open(file);
+	return mount(mappedFile, format, fileSystem);
+}
+
+
+//-------------------------------------------------
+//  mount
+//-------------------------------------------------
+
+Floptool::Image::ptr Floptool::mount(const MappedFile::ptr &file, const Floptool::FloppyFormat &format, const Floptool::FileSystem &fileSystem) const
+{
+	// plain sector dumps can be mounted without decoding them at all
+	Image::ptr image = mountRaw(file, format, fileSystem);
+	if (image)
+		return image;
+
+	DecodedImage::ptr decodedImage = decode(file, format);
+	return decodedImage
+		? mount(*decodedImage, fileSystem)
+		: Image::ptr();
+}
+
+
+//-------------------------------------------------
+//  mountRaw - mounts a plain sector dump straight
+//	from the file, if that is what it is; callers
+//	that decode try this first, so that they only
+//	decode images that need it
+//-------------------------------------------------
+
+Floptool::Image::ptr Floptool::mountRaw(const MappedFile::ptr &file, const Floptool::FloppyFormat &format, const Floptool::FileSystem &fileSystem) const
+{
+	MameFileSystemFormatEnumeratorImpl fsEnum;
+	fileSystem.m_mameFsManager.enumerate_f(fsEnum);
+	std::unique_ptr<fs::fsblk_t> rawBlockDevice = createRawBlockDevice(file, format.m_mameFormat, fsEnum.fileSystemFormats());
+	return rawBlockDevice
+		? std::make_unique<Image>(format, fileSystem, std::move(rawBlockDevice))
+		: Image::ptr();
+}
+
+
+//-------------------------------------------------
+//  decode
+//-------------------------------------------------
+
+Floptool::DecodedImage::ptr Floptool::decode(const MappedFile::ptr &file, const Floptool::FloppyFormat &format) const
+{
+	MameMappedRead randomRead(*file);
+
+	// try to load the image
+	std::vector<uint32_t> variants;
+	auto mameFloppyImage = std::make_unique<floppy_image>(84, 2, floppy_image::FF_UNKNOWN);
+	if (!format.m_mameFormat.load(randomRead, floppy_image::FF_UNKNOWN, variants, mameFloppyImage.get()))
+		return {};
+
+	return std::make_shared<DecodedImage>(format, MappedFile::ptr(file), std::move(mameFloppyImage));
+}
+
+
+//-------------------------------------------------
+//  mount
+//-------------------------------------------------
+
+Floptool::Image::ptr Floptool::mount(const DecodedImage &decodedImage, const Floptool::FileSystem &fileSystem) const
+{
+	floppy_image &mameFloppyImage = decodedImage.mameFloppyImage();
+
+	// mounts with the first of a list of file system formats that reproduces the size the
+	// file system expects
+	auto mountConverted = [&decodedImage, &fileSystem, &mameFloppyImage](const std::vector<MameFileSystemFormatEnumeratorImpl::FileSystemFormat> &fileSystemFormats) -> Image::ptr
+	{
+		// if the source is a plain sector dump in the layout the file system wants, skip
+		// the floppy_image round trip and use the file's bytes as they are
+		std::unique_ptr<fs::fsblk_t> rawBlockDevice = createRawBlockDevice(decodedImage.file(), decodedImage.floppyFormat().m_mameFormat, fileSystemFormats);
+		if (rawBlockDevice)
+			return std::make_unique<Image>(decodedImage.floppyFormat(), fileSystem, std::move(rawBlockDevice));
+
+		// convert the image to something more usable; conversions are cached on the decoded
+		// image, so each converter is run at most once across all file systems tried
+		for (const auto &ci : fileSystemFormats)
+		{
+			// PC-style images can be decoded lazily, one track at a time as the file system
+			// touches them, rather than converting the whole image up front
+			const std::optional<LazySectorImage::TrackLayout> &trackLayout = decodedImage.trackLayout();
+			std::optional<LazySectorImage::Geometry> lazyGeometry = trackLayout
+				? LazySectorImage::predictGeometry(mameFloppyImage, *trackLayout, ci.m_type, ci.m_imageSize)
+				: std::nullopt;
+			if (lazyGeometry)
+			{
+				auto blockDevice = std::make_unique<LazySectorImage>(decodedImage.shared_from_this(), mameFloppyImage, *lazyGeometry);
+				return std::make_unique<Image>(decodedImage.floppyFormat(), fileSystem, std::move(blockDevice));
+			}
+
+			SectorImage sectorImage = decodedImage.convert(ci.m_type);
+			if (ci.m_imageSize == sectorImage->size())
+			{
+				auto blockDevice = std::make_unique<MameSectorImageBlockDevice>(std::move(sectorImage));
+				return std::make_unique<Image>(decodedImage.floppyFormat(), fileSystem, std::move(blockDevice));
+			}
+		}
+		return {};
+	};
+
+	// figure out what file system formats can be used; if the decoded image knows its
+	// geometry, only enumerate the formats whose form factor and variant match so that we
+	// do not pay for save() on converters whose output size cannot possibly match
+	uint32_t formFactor = mameFloppyImage.get_form_factor();
+	uint32_t variant = mameFloppyImage.get_variant();
+	if (variant == 0)
+		formFactor = floppy_image::FF_UNKNOWN;
+	MameFileSystemFormatEnumeratorImpl fsEnum(formFactor, variant);
+	fileSystem.m_mameFsManager.enumerate_f(fsEnum);
+	Image::ptr result = mountConverted(fsEnum.fileSystemFormats());
+
+	// some loaders report a geometry that the file system does not list, or that none of
+	// the listed converters reproduce; in that case fall back to trying everything, which
+	// is what we would have done had we known nothing about the geometry (conversions that
+	// were already tried come out of the cache)
+	if (!result && formFactor != floppy_image::FF_UNKNOWN)
+	{
+		MameFileSystemFormatEnumeratorImpl fallbackFsEnum;
+		fileSystem.m_mameFsManager.enumerate_f(fallbackFsEnum);
+		result = mountConverted(fallbackFsEnum.fileSystemFormats());
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  DecodedImage::trackLayout
+//-------------------------------------------------
+
+const std::optional<LazySectorImage::TrackLayout> &Floptool::DecodedImage::trackLayout() const
+{
+	std::call_once(m_trackLayoutOnce, [this]
+	{
+		m_trackLayout = LazySectorImage::probeTrackLayout(*m_mameFloppyImage);
+	});
+	return m_trackLayout;
+}
+
+
+//-------------------------------------------------
+//  DecodedImage::convert
+//-------------------------------------------------
+
+Floptool::SectorImage Floptool::DecodedImage::convert(const floppy_image_format_t &converter) const
+{
+	{
+		std::lock_guard lock(m_conversionsMutex);
+		auto iter = m_conversions.find(&converter);
+		if (iter != m_conversions.end())
+			return iter->second;
+	}
+
+	// target the sector image with a stream, and convert to the right format
+	SectorImage sectorImage = std::make_shared<std::vector<uint8_t>>();
+	util::random_read_write_fill_wrapper<util::vector_read_write_adapter<uint8_t>, 0xff> io(*sectorImage);
+	std::vector<uint32_t> variants;
+	converter.save(io, variants, m_mameFloppyImage.get());
+
+	// if somebody else raced us to this conversion, theirs wins
+	std::lock_guard lock(m_conversionsMutex);
+	return m_conversions.try_emplace(&converter, std::move(sectorImage)).first->second;
+}
+
+
+//-------------------------------------------------
+//  FloppyFormat ctor
+//-------------------------------------------------
+
+Floptool::FloppyFormat::FloppyFormat(const floppy_image_format_t &mameFormat)
+	: m_mameFormat(mameFormat)
+{
+	// build file extensions
+	const char *extensions = m_mameFormat.extensions();
+	while (extensions && *extensions)
+	{
+		const char *s = strchr(extensions, ',');
+
+		QString ext = QString::fromUtf8(extensions, s ? s - extensions : -1);
+		m_fileExtensions.push_back(std::move(ext));
+
+		extensions = s ? s + 1 : nullptr;
+	}
+	m_fileExtensions.shrink_to_fit();
+}
+
+
+//-------------------------------------------------
+//  FloppyFormat::name
+//-------------------------------------------------
+
+QString Floptool::FloppyFormat::name() const
+{
+	return m_mameFormat.name();
+}
+
+
+//-------------------------------------------------
+//  FloppyFormat::description
+//-------------------------------------------------
+
+QString Floptool::FloppyFormat::description() const
+{
+	return QString::fromUtf8(m_mameFormat.description());
+}
+
+
+//-------------------------------------------------
+//  FileSystem ctor
+//-------------------------------------------------
+
+Floptool::FileSystem::FileSystem(const fs::manager_t &mameFsManager)
+	: m_mameFsManager(mameFsManager)
+{
+}
+
+
+//-------------------------------------------------
+//  FileSystem::name
+//-------------------------------------------------
+
+QString Floptool::FileSystem::name() const
+{
+	return m_mameFsManager.name();
+}
+
+
+//-------------------------------------------------
+//  FileSystem::description
+//-------------------------------------------------
+
+QString Floptool::FileSystem::description() const
+{
+	return QString::fromUtf8(m_mameFsManager.description());
+}
+
+
+//-------------------------------------------------
+//  FileSystem::canRead
+//-------------------------------------------------
+
+bool Floptool::FileSystem::canRead() const
+{
+	return m_mameFsManager.can_read();
+}
+
+
+//-------------------------------------------------
+//  Category ctor
+//-------------------------------------------------
+
+template<class T>
+Floptool::Category<T>::Category(const QString &categoryName)
+	: m_categoryName(categoryName)
+{
+}
+
+
+//-------------------------------------------------
+//  DecodedImage ctor
+//-------------------------------------------------
+
+Floptool::DecodedImage::DecodedImage(const FloppyFormat &format, MappedFile::ptr &&file, std::unique_ptr<floppy_image> &&mameFloppyImage)
+	: m_format(format)
+	, m_file(std::move(file))
+	, m_mameFloppyImage(std::move(mameFloppyImage))
+{
+}
+
+
+//-------------------------------------------------
+//  DecodedImage dtor
+//-------------------------------------------------
+
+Floptool::DecodedImage::~DecodedImage()
+{
+}
+
+
+//-------------------------------------------------
+//  Image ctor
+//-------------------------------------------------
+
+Floptool::Image::Image(const Floptool::FloppyFormat &format, const Floptool::FileSystem &fileSystem, std::unique_ptr<fs::fsblk_t> &&blockDevice)
+	: m_format(format)
+	, m_fileSystem(fileSystem)
+	, m_mameFsBlk(std::move(blockDevice))
+{
+	m_mameFs = m_fileSystem.m_mameFsManager.mount(*m_mameFsBlk);
+}
+
+
+//-------------------------------------------------
+//  Image dtor
+//-------------------------------------------------
+
+Floptool::Image::~Image()
+{
+}
+
+
+//-------------------------------------------------
+//  Image::convert
+//-------------------------------------------------
+
+QString Floptool::Image::convert(std::string_view s) const
+{
+	return QString::fromLocal8Bit(s);
+}
+
+
+//-------------------------------------------------
+//  Image::volumeName
+//-------------------------------------------------
+
+std::optional<QString> Floptool::Image::volumeName() const
+{
+	fs::meta_data meta = m_mameFs->volume_metadata();
+	std::optional<QString> result;
+	if (meta.has(fs::meta_name::name))
+		result = convert(meta.get(fs::meta_name::name).as_string());
+	return result;	
+}
+
+
+//-------------------------------------------------
+//  Image::readFile
+//-------------------------------------------------
+
+std::optional<std::vector<uint8_t>> Floptool::Image::readFile(const std::vector<std::string> &path) const
+{
+	return readFile(mameFileSystem(), path);
+}
+
+
+//-------------------------------------------------
+//  Image::readFile
+//-------------------------------------------------
+
+std::optional<std::vector<uint8_t>> Floptool::Image::readFile(fs::filesystem_t &mameFileSystem, const std::vector<std::string> &path)
+{
+	auto [err, bytes] = mameFileSystem.file_read(path);
+	return err
+		? std::nullopt
+		: std::optional<std::vector<uint8_t>>(std::move(bytes));
+}
+
+
+//-------------------------------------------------
+//  Image::directoryContents
+//-------------------------------------------------
+
+std::optional<std::vector<fs::dir_entry>> Floptool::Image::directoryContents(const std::vector<std::string> &path) const
+{
+	return directoryContents(mameFileSystem(), path);
+}
+
+
+//-------------------------------------------------
+//  Image::directoryContents
+//-------------------------------------------------
+
+std::optional<std::vector<fs::dir_entry>> Floptool::Image::directoryContents(fs::filesystem_t &mameFileSystem, const std::vector<std::string> &path)
+{
+	auto [err, entries] = mameFileSystem.directory_contents(path);
+	if (err)
+		return std::nullopt;
+
+	// file systems hand us each entry's metadata as part of the directory pass, so there
+	// is no need to resolve every child's path from the root again; the exception is the
+	// odd file system that leaves it out, which we fill in the slow way
+	std::vector<std::string> childPath;
+	for (fs::dir_entry &entry : entries)
+	{
+		if (!entry.m_meta.has(fs::meta_name::name))
+		{
+			childPath = path;
+			childPath.push_back(entry.m_name);
+			auto [metadataErr, metadata] = mameFileSystem.metadata(childPath);
+			if (!metadataErr)
+				entry.m_meta = std::move(metadata);
+		}
+	}
+	return std::move(entries);
+}
+
+
+//-------------------------------------------------
+//  Image::createSnapshot
+//-------------------------------------------------
+
+std::unique_ptr<fs::filesystem_t> Floptool::Image::createSnapshot() const
+{
+	// a second file system instance over the same (read only) block device, so that a
+	// worker thread can walk the image while the GUI thread keeps using the primary one;
+	// the snapshot must not outlive this image
+	return m_fileSystem.m_mameFsManager.mount(*m_mameFsBlk);
+}
+
+
+//-------------------------------------------------
+//  Image::preload
+//-------------------------------------------------
+
+void Floptool::Image::preload() const
+{
+	// callers that are about to read most of the image are better off having all tracks
+	// decoded in parallel up front than one at a time as the file system touches them
+	LazySectorImage *lazySectorImage = dynamic_cast<LazySectorImage *>(m_mameFsBlk.get());
+	if (lazySectorImage)
+		lazySectorImage->decodeAll();
+}
+
+
+//-------------------------------------------------
+//  MameFormatsEnumeratorImpl ctor
+//-------------------------------------------------
+
+Floptool::MameFormatsEnumeratorImpl::MameFormatsEnumeratorImpl(Floptool &host)
+	: m_host(host)
+{
+}
+
+
+//-------------------------------------------------
+//  MameFormatsEnumeratorImpl::category
+//-------------------------------------------------
+
+void Floptool::MameFormatsEnumeratorImpl::category(const char *name)
+{
+	m_currentCategory = QString::fromUtf8(name);
+}
+
+
+//-------------------------------------------------
+//  MameFormatsEnumeratorImpl::add(const cassette_image::Format *const *)
+//-------------------------------------------------
+
+void Floptool::MameFormatsEnumeratorImpl::add(const cassette_image::Format *const *formats)
+{
+}
+
+
+//-------------------------------------------------
+//  MameFormatsEnumeratorImpl::add(const floppy_image_format_t &)
+//-------------------------------------------------
+
+void Floptool::MameFormatsEnumeratorImpl::add(const floppy_image_format_t &mameFormat)
+{
+	if (m_host.m_floppyFormats.empty() || m_host.m_floppyFormats.back().categoryName() != m_currentCategory)
+		m_host.m_floppyFormats.emplace_back(m_currentCategory);
+	m_host.m_floppyFormats.back().emplace_back(mameFormat);
+}
+
+
+//-------------------------------------------------
+//  MameFormatsEnumeratorImpl::add(const fs::manager_t &)
+//-------------------------------------------------
+
+void Floptool::MameFormatsEnumeratorImpl::add(const fs::manager_t &mameFsManager)
+{
+	if (m_host.m_fileSystems.empty() || m_host.m_fileSystems.back().categoryName() != m_currentCategory)
+		m_host.m_fileSystems.emplace_back(m_currentCategory);
+	m_host.m_fileSystems.back().emplace_back(mameFsManager);
+}
+
+
+//-------------------------------------------------
+//  MameFileSystemFormatEnumeratorImpl ctor
+//-------------------------------------------------
+
+MameFileSystemFormatEnumeratorImpl::MameFileSystemFormatEnumeratorImpl(uint32_t formFactor, uint32_t variant)
+	: fs::manager_t::floppy_enumerator(formFactor, m_variants)
+{
+	// the base class holds onto a reference to m_variants, so we can populate it late
+	if (formFactor != floppy_image::FF_UNKNOWN)
+		m_variants.push_back(variant);
+}
+
+
+//-------------------------------------------------
+//  MameFileSystemFormatEnumeratorImpl::add_raw
+//-------------------------------------------------
+
+void MameFileSystemFormatEnumeratorImpl::add_raw(const char *name, uint32_t key, const char *description)
+{
+}
+
+
+//-------------------------------------------------
+//  MameFileSystemFormatEnumeratorImpl::add_format
+//-------------------------------------------------
+
+void MameFileSystemFormatEnumeratorImpl::add_format(const floppy_image_format_t &type, uint32_t image_size, const char *name, const char *description)
+{
+	m_fileSystemFormats.emplace_back(type, image_size, name, description);
+}
+
+
+//-------------------------------------------------
+//  MameFileSystemFormatEnumeratorImpl::FileSystemFormat ctor
+//-------------------------------------------------
+
+MameFileSystemFormatEnumeratorImpl::FileSystemFormat::FileSystemFormat(const floppy_image_format_t &type, uint32_t image_size, const char *name, const char *description)
+	: m_type(type)
+	, m_imageSize(image_size)
+	, m_name(name)
+	, m_description(description)
+{
+}
+
+
+//-------------------------------------------------
+//  MameMappedRead ctor
+//-------------------------------------------------
+
+MameMappedRead::MameMappedRead(const MappedFile &file)
+	: m_bytes(file.bytes())
+	, m_position(0)
+{
+}
+
+
+//-------------------------------------------------
+//  MameMappedRead::read
+//-------------------------------------------------
+
+std::error_condition MameMappedRead::read(void *buffer, std::size_t length, std::size_t &actual) noexcept
+{
+	std::error_condition err = read_at(m_position, buffer, length, actual);
+	m_position += actual;
+	return err;
+}
+
+
+//-------------------------------------------------
+//  MameMappedRead::seek
+//-------------------------------------------------
+
+std::error_condition MameMappedRead::seek(std::int64_t offset, int whence) noexcept
+{
+	switch (whence)
+	{
+	case SEEK_SET:
+		// do nothing
+		break;
+
+	case SEEK_CUR:
+		offset += m_position;
+		break;
+
+	case SEEK_END:
+		offset += m_bytes.size();
+		break;
+	}
+	if (offset < 0)
+		return std::errc::invalid_argument;
+
+	m_position = offset;
+	return std::error_condition();
+}
+
+
+//-------------------------------------------------
+//  MameMappedRead::tell
+//-------------------------------------------------
+
+std::error_condition MameMappedRead::tell(std::uint64_t &result) noexcept
+{
+	result = m_position;
+	return std::error_condition();
+}
+
+
+//-------------------------------------------------
+//  MameMappedRead::length
+//-------------------------------------------------
+
+std::error_condition MameMappedRead::length(std::uint64_t &result) noexcept
+{
+	result = m_bytes.size();
+	return std::error_condition();
+}
+
+
+//-------------------------------------------------
+//  MameMappedRead::read_at
+//-------------------------------------------------
+
+std::error_condition MameMappedRead::read_at(std::uint64_t offset, void *buffer, std::size_t length, std::size_t &actual) noexcept
+{
+	std::uint64_t size = m_bytes.size();
+	actual = offset < size
+		? (std::size_t) std::min<std::uint64_t>(length, size - offset)
+		: 0;
+	if (actual > 0)
+		memcpy(buffer, m_bytes.data() + offset, actual);
+	return std::error_condition();
+}
+
+
+//-------------------------------------------------
+//  MameSectorImageBlockDevice ctor
+//-------------------------------------------------
+
+MameSectorImageBlockDevice::MameSectorImageBlockDevice(Floptool::SectorImage &&sectorImage)
+	: fs::fsblk_vec_t(*sectorImage)
+	, m_sectorImage(std::move(sectorImage))
+{
+}
+
+
+//-------------------------------------------------
+//  MameMappedBlockDevice ctor
+//-------------------------------------------------
+
+MameMappedBlockDevice::MameMappedBlockDevice(const MappedFile::ptr &file)
+	: m_file(file)
+{
+}
+
+
+//-------------------------------------------------
+//  MameMappedBlockDevice::block_count
+//-------------------------------------------------
+
+uint32_t MameMappedBlockDevice::block_count() const
+{
+	return m_file->size() / m_block_size;
+}
+
+
+//-------------------------------------------------
+//  MameMappedBlockDevice::get
+//-------------------------------------------------
+
+fs::fsblk_t::block_t MameMappedBlockDevice::get(uint32_t id)
+{
+	if (id >= block_count())
+		throw std::out_of_range("Block number overflow");
+	return block_t(new Block(m_file->bytes().data() + (std::size_t)m_block_size * id, m_block_size));
+}
+
+
+//-------------------------------------------------
+//  MameMappedBlockDevice::fill
+//-------------------------------------------------
+
+void MameMappedBlockDevice::fill(uint8_t data)
+{
+	throw std::logic_error("Mapped block devices are read only");
+}
+
+
+//-------------------------------------------------
+//  MameMappedBlockDevice::Block ctor
+//-------------------------------------------------
+
+MameMappedBlockDevice::Block::Block(const uint8_t *data, uint32_t size)
+	: iblock_t(size)
+	, m_data(data)
+{
+}
+
+
+//-------------------------------------------------
+//  MameMappedBlockDevice::Block::rodata
+//-------------------------------------------------
+
+const uint8_t *MameMappedBlockDevice::Block::rodata()
+{
+	return m_data;
+}
+
+
+//-------------------------------------------------
+//  MameMappedBlockDevice::Block::data
+//-------------------------------------------------
+
+uint8_t *MameMappedBlockDevice::Block::data()
+{
+	// the file may well be mapped read only, so we cannot hand out writable pointers
+	throw std::logic_error("Mapped block devices are read only");
+}
@@ -1,158 +1,239 @@
-/***************************************************************************
-
-	floptool.h
-
-	Interface with floptool command line program
-
-***************************************************************************/
-
-#ifndef FLOPTOOL_H
-#define FLOPTOOL_H
-
-// Qt headers
-#include <QObject>
-
-
-// MAME forward declarations
-class floppy_image_format_t;
-namespace fs
-{
-	class manager_t;
-	class fsblk_t;
-	class filesystem_t;
-};
-
-
-//**************************************************************************
-//  TYPE DECLARATIONS
-//**************************************************************************
-
-// ======================> Floptool
-
-class Floptool : public QObject
-{
-	Q_OBJECT
-public:
-	// ======================> Floptool
-	class FloppyFormat
-	{
-		friend class Floptool;
-	public:
-		// ctor
-		FloppyFormat(const floppy_image_format_t &mameFormat);
-
-		// methods
-		QString name() const;
-		QString description() const;
-		const std::vector<QString> &fileExtensions() const { return m_fileExtensions; }
-
-	private:
-		const floppy_image_format_t &	m_mameFormat;
-		std::vector<QString>			m_fileExtensions;
-	};
-
-
-	// ======================> FileSystem
-	class FileSystem
-	{
-		friend class Floptool;
-	public:
-		// ctor
-		FileSystem(const fs::manager_t &mameFsManager);
-
-		// accessor
-		const fs::manager_t &mameManager() const { return m_mameFsManager; }
-
-		// methods
-		QString name() const;
-		QString description() const;
-		bool canRead() const;
-
-	private:
-		const fs::manager_t &			m_mameFsManager;
-	};
-
-
-	// ======================> Category
-	template<class T>
-	class Category : public std::vector<T>
-	{
-	public:
-		// ctor
-		Category(const QString &categoryName);
-
-		// accessor
-		const QString &categoryName() const { return m_categoryName;  }
-
-	private:
-		QString	m_categoryName;
-	};
-
-
-	// ======================> Image
-	class Image
-	{
-	public:
-		typedef std::unique_ptr<Image> ptr;
-
-		// ctor/dtor
-		Image(const FloppyFormat &format, const FileSystem &fileSystem, std::vector<uint8_t> &&sectorImage);
-		Image(const Image &) = delete;
-		Image(Image &&) = delete;
-		~Image();
-
-		// accessors
-		const FloppyFormat &floppyFormat() const { return m_format; }
-		const FileSystem &fileSystem() const { return m_fileSystem; }
-		fs::filesystem_t &mameFileSystem() const { return *m_mameFs; }
-
-		// methods
-		QString convert(std::string_view s) const;
-		std::optional<QString> volumeName() const;
-		std::optional<std::vector<uint8_t>> readFile(const std::vector<std::string> &path) const;
-
-	private:
-		const FloppyFormat &				m_format;
-		const FileSystem &					m_fileSystem;
-		std::vector<uint8_t>				m_sectorImage;
-		std::unique_ptr<fs::fsblk_t>		m_mameFsBlk;
-		std::unique_ptr<fs::filesystem_t>	m_mameFs;
-	};
-
-	// typedefs
-	typedef std::tuple<uint8_t, std::reference_wrapper<const FloppyFormat>> IdentifyResult;
-	typedef Category<IdentifyResult> IdentifyResultCategory;
-
-	// ctor/dtor
-	Floptool();
-	~Floptool();
-
-	// statics
-	static Floptool &instance();
-
-	// methods
-	void initializeMameFormats();
-
-	// accessors
-	const std::vector<Category<FloppyFormat>> &floppyFormats() const	{ return m_floppyFormats; }
-	const std::vector<Category<FileSystem>> &fileSystems() const		{ return m_fileSystems; }
-
-	// methods
-	std::vector<IdentifyResultCategory> identify(QIODevice &file) const;
-	Image::ptr mount(QIODevice &file, const Floptool::FloppyFormat &format, const Floptool::FileSystem &fileSystem) const;
-	const FloppyFormat *findFloppyFormat(const QString &name) const;
-	const FileSystem *findFileSystem(const QString &name) const;
-
-private:
-	class MameFormatsEnumeratorImpl;
-
-	// static members
-	static Floptool *s_instance;
-
-	// members
-	std::vector<Category<FloppyFormat>>		m_floppyFormats;
-	std::vector<Category<FileSystem>>		m_fileSystems;
-};
-
-
-#endif // FLOPTOOL_H
+/***************************************************************************
+
+	floptool.h
+
+	Interface with floptool command line program
+
+***************************************************************************/
+
+#ifndef FLOPTOOL_H
+#define FLOPTOOL_H
+
+// qfloptool headers
+#include "identifyprefilter.h"
+#include "lazysectorimage.h"
+#include "mappedfile.h"
+
+// Qt headers
+#include <QObject>
+
+// C++ headers
+#include <mutex>
+#include <unordered_map>
+
+
+class IdentifyCache;
+
+
+// MAME forward declarations
+class floppy_image;
+class floppy_image_format_t;
+namespace fs
+{
+	class manager_t;
+	class fsblk_t;
+	class filesystem_t;
+	struct dir_entry;
+};
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> Floptool
+
+class Floptool : public QObject
+{
+	Q_OBJECT
+public:
+	// ======================> Floptool
+	class FloppyFormat
+	{
+		friend class Floptool;
+	public:
+		// ctor
+		FloppyFormat(const floppy_image_format_t &mameFormat);
+
+		// methods
+		QString name() const;
+		QString description() const;
+		const std::vector<QString> &fileExtensions() const { return m_fileExtensions; }
+
+	private:
+		const floppy_image_format_t &	m_mameFormat;
+		std::vector<QString>			m_fileExtensions;
+	};
+
+
+	// ======================> FileSystem
+	class FileSystem
+	{
+		friend class Floptool;
+	public:
+		// ctor
+		FileSystem(const fs::manager_t &mameFsManager);
+
+		// accessor
+		const fs::manager_t &mameManager() const { return m_mameFsManager; }
+
+		// methods
+		QString name() const;
+		QString description() const;
+		bool canRead() const;
+
+	private:
+		const fs::manager_t &			m_mameFsManager;
+	};
+
+
+	// ======================> Category
+	template<class T>
+	class Category : public std::vector<T>
+	{
+	public:
+		// ctor
+		Category(const QString &categoryName);
+
+		// accessor
+		const QString &categoryName() const { return m_categoryName;  }
+
+	private:
+		QString	m_categoryName;
+	};
+
+
+	// sector images are shared between conversion caches and mounted images; they are
+	// never written to once the conversion is complete
+	typedef std::shared_ptr<std::vector<uint8_t>> SectorImage;
+
+
+	// ======================> DecodedImage
+	class DecodedImage : public std::enable_shared_from_this<DecodedImage>
+	{
+		friend class Floptool;
+	public:
+		typedef std::shared_ptr<DecodedImage> ptr;
+
+		// ctor/dtor
+		DecodedImage(const FloppyFormat &format, MappedFile::ptr &&file, std::unique_ptr<floppy_image> &&mameFloppyImage);
+		DecodedImage(const DecodedImage &) = delete;
+		DecodedImage(DecodedImage &&) = delete;
+		~DecodedImage();
+
+		// accessors
+		const FloppyFormat &floppyFormat() const		{ return m_format; }
+		const MappedFile::ptr &file() const				{ return m_file; }
+		floppy_image &mameFloppyImage() const			{ return *m_mameFloppyImage; }
+
+		// methods
+		SectorImage convert(const floppy_image_format_t &converter) const;
+		const std::optional<LazySectorImage::TrackLayout> &trackLayout() const;
+
+	private:
+		const FloppyFormat &				m_format;
+		MappedFile::ptr						m_file;
+		std::unique_ptr<floppy_image>		m_mameFloppyImage;
+
+		// conversions already performed, keyed by converter
+		mutable std::mutex																m_conversionsMutex;
+		mutable std::unordered_map<const floppy_image_format_t *, SectorImage>		m_conversions;
+
+		// layout of track 0, used to decode PC-style images lazily
+		mutable std::once_flag												m_trackLayoutOnce;
+		mutable std::optional<LazySectorImage::TrackLayout>					m_trackLayout;
+	};
+
+
+	// ======================> Image
+	class Image
+	{
+	public:
+		typedef std::unique_ptr<Image> ptr;
+
+		// ctor/dtor
+		Image(const FloppyFormat &format, const FileSystem &fileSystem, std::unique_ptr<fs::fsblk_t> &&blockDevice);
+		Image(const Image &) = delete;
+		Image(Image &&) = delete;
+		~Image();
+
+		// accessors
+		const FloppyFormat &floppyFormat() const { return m_format; }
+		const FileSystem &fileSystem() const { return m_fileSystem; }
+		fs::filesystem_t &mameFileSystem() const { return *m_mameFs; }
+
+		// methods
+		QString convert(std::string_view s) const;
+		std::optional<QString> volumeName() const;
+		std::optional<std::vector<uint8_t>> readFile(const std::vector<std::string> &path) const;
+		std::optional<std::vector<fs::dir_entry>> directoryContents(const std::vector<std::string> &path) const;
+		std::unique_ptr<fs::filesystem_t> createSnapshot() const;
+
+		// statics
+		static std::optional<std::vector<uint8_t>> readFile(fs::filesystem_t &mameFileSystem, const std::vector<std::string> &path);
+		static std::optional<std::vector<fs::dir_entry>> directoryContents(fs::filesystem_t &mameFileSystem, const std::vector<std::string> &path);
+		void preload() const;
+
+	private:
+		const FloppyFormat &				m_format;
+		const FileSystem &					m_fileSystem;
+		std::unique_ptr<fs::fsblk_t>		m_mameFsBlk;
+		std::unique_ptr<fs::filesystem_t>	m_mameFs;
+	};
+
+	// typedefs
+	typedef std::tuple<uint8_t, std::reference_wrapper<const FloppyFormat>> IdentifyResult;
+	typedef Category<IdentifyResult> IdentifyResultCategory;
+
+	// how thoroughly identify() probes
+	enum class IdentifyMode
+	{
+		Prefiltered,	// only probe formats that pass the signature prefilter
+		Exhaustive		// probe every format; used to validate the prefilter
+	};
+
+	// ctor/dtor
+	Floptool();
+	~Floptool();
+
+	// statics
+	static Floptool &instance();
+
+	// methods
+	void initializeMameFormats();
+	void enableIdentifyCache(const QString &fileName);
+	void disableIdentifyCache();
+
+	// accessors
+	const std::vector<Category<FloppyFormat>> &floppyFormats() const	{ return m_floppyFormats; }
+	const std::vector<Category<FileSystem>> &fileSystems() const		{ return m_fileSystems; }
+	std::uint64_t formatSetFingerprint() const							{ return m_formatSetFingerprint; }
+
+	// methods
+	std::vector<IdentifyResultCategory> identify(QIODevice &file, IdentifyMode mode = IdentifyMode::Prefiltered) const;
+	std::vector<IdentifyResultCategory> identify(const MappedFile &file, IdentifyMode mode = IdentifyMode::Prefiltered) const;
+	DecodedImage::ptr decode(const MappedFile::ptr &file, const Floptool::FloppyFormat &format) const;
+	Image::ptr mount(QIODevice &file, const Floptool::FloppyFormat &format, const Floptool::FileSystem &fileSystem) const;
+	Image::ptr mount(const MappedFile::ptr &file, const Floptool::FloppyFormat &format, const Floptool::FileSystem &fileSystem) const;
+	Image::ptr mount(const DecodedImage &decodedImage, const Floptool::FileSystem &fileSystem) const;
+	Image::ptr mountRaw(const MappedFile::ptr &file, const Floptool::FloppyFormat &format, const Floptool::FileSystem &fileSystem) const;
+	const FloppyFormat *findFloppyFormat(const QString &name) const;
+	const Category<FloppyFormat> *findFloppyFormatCategory(const FloppyFormat &floppyFormat) const;
+	const FileSystem *findFileSystem(const QString &name) const;
+
+private:
+	class MameFormatsEnumeratorImpl;
+
+	// static members
+	static Floptool *s_instance;
+
+	// members
+	std::vector<Category<FloppyFormat>>		m_floppyFormats;
+	std::vector<Category<FileSystem>>		m_fileSystems;
+	IdentifyPrefilter						m_identifyPrefilter;
+	std::uint64_t							m_formatSetFingerprint;
+	std::unique_ptr<IdentifyCache>			m_identifyCache;
+};
+
+
+#endif // FLOPTOOL_H
@@ -0,0 +1,311 @@
+/***************************************************************************
+
+	identifycache.cpp
+
+	Persistent cache of identify() results
+
+***************************************************************************/
+
+// qfloptool headers
+#include "identifycache.h"
+#include "mappedfile.h"
+
+// Qt headers
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+// C++ headers
+#include <algorithm>
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+static const quint32 s_magic = 0x43494651;		// 'QFIC'
+static const quint32 s_version = 1;
+static const std::size_t s_maximumRecords = 8192;
+static const std::size_t s_trimmedRecords = s_maximumRecords * 7 / 8;
+static const int s_saveInterval = 64;
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+IdentifyCache::IdentifyCache(const QString &fileName, std::uint64_t formatSetFingerprint)
+	: m_fileName(fileName)
+	, m_formatSetFingerprint(formatSetFingerprint)
+	, m_clock(0)
+	, m_unsavedCount(0)
+{
+	load();
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+IdentifyCache::~IdentifyCache()
+{
+	save();
+}
+
+
+//-------------------------------------------------
+//  defaultFileName - the cache lives alongside our
+//	settings
+//-------------------------------------------------
+
+QString IdentifyCache::defaultFileName()
+{
+	QString directory = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+	return QDir(directory).filePath("identifycache.dat");
+}
+
+
+//-------------------------------------------------
+//  defaultScanFileName - bulk scans get a cache of
+//	their own, so that they do not flush out the
+//	records that the interactive app relies on
+//-------------------------------------------------
+
+QString IdentifyCache::defaultScanFileName()
+{
+	QString directory = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
+	return QDir(directory).filePath("scancache.dat");
+}
+
+
+//-------------------------------------------------
+//  keyForFile
+//-------------------------------------------------
+
+std::optional<IdentifyCache::Key> IdentifyCache::keyForFile(const MappedFile &file)
+{
+	// we can only cache real files
+	if (file.fileName().isEmpty())
+		return std::nullopt;
+
+	QFileInfo fileInfo(file.fileName());
+	Key result;
+	result.m_fileSize = file.size();
+	result.m_modifiedTime = fileInfo.lastModified().toMSecsSinceEpoch();
+	result.m_contentHash = hashBytes(file.bytes());
+	return result;
+}
+
+
+//-------------------------------------------------
+//  hashBytes - 64-bit FNV-1a; we need something
+//	stable across runs and Qt versions, so qHash()
+//	is not suitable
+//-------------------------------------------------
+
+std::uint64_t IdentifyCache::hashBytes(std::span<const uint8_t> bytes, std::uint64_t hash)
+{
+	for (uint8_t b : bytes)
+	{
+		hash ^= b;
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+
+//-------------------------------------------------
+//  find
+//-------------------------------------------------
+
+std::optional<std::vector<IdentifyCache::Entry>> IdentifyCache::find(const Key &key)
+{
+	std::lock_guard lock(m_mutex);
+	auto iter = m_records.find(key);
+	if (iter == m_records.end())
+		return std::nullopt;
+
+	iter->second.m_lastUsed = ++m_clock;
+	return iter->second.m_entries;
+}
+
+
+//-------------------------------------------------
+//  insert
+//-------------------------------------------------
+
+void IdentifyCache::insert(const Key &key, std::vector<Entry> &&entries)
+{
+	bool isSaveDue;
+	{
+		std::lock_guard lock(m_mutex);
+		Record &record = m_records[key];
+		record.m_entries = std::move(entries);
+		record.m_lastUsed = ++m_clock;
+		trim();
+		isSaveDue = ++m_unsavedCount >= s_saveInterval;
+	}
+
+	// we save periodically, so that a batch of inserts does not rewrite the file every
+	// time; if another thread is already saving, what we have will go out with the next
+	if (isSaveDue)
+		internalSave(false);
+}
+
+
+//-------------------------------------------------
+//  save
+//-------------------------------------------------
+
+void IdentifyCache::save()
+{
+	internalSave(true);
+}
+
+
+//-------------------------------------------------
+//  load
+//-------------------------------------------------
+
+void IdentifyCache::load()
+{
+	QFile file(m_fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+
+	QDataStream stream(&file);
+	quint32 magic, version;
+	quint64 formatSetFingerprint, recordCount;
+	stream >> magic >> version >> formatSetFingerprint >> recordCount;
+
+	// a cache built against a different set of MAME formats is useless to us
+	if (stream.status() != QDataStream::Ok || magic != s_magic || version != s_version || formatSetFingerprint != m_formatSetFingerprint)
+		return;
+
+	for (quint64 i = 0; i < recordCount && stream.status() == QDataStream::Ok; i++)
+	{
+		Key key;
+		quint64 fileSize, contentHash, entryCount;
+		qint64 modifiedTime;
+		stream >> fileSize >> modifiedTime >> contentHash >> entryCount;
+		key.m_fileSize = fileSize;
+		key.m_modifiedTime = modifiedTime;
+		key.m_contentHash = contentHash;
+
+		Record record;
+		record.m_lastUsed = i;
+		for (quint64 j = 0; j < entryCount && stream.status() == QDataStream::Ok; j++)
+		{
+			Entry &entry = record.m_entries.emplace_back();
+			quint8 score;
+			stream >> entry.m_formatName >> score;
+			entry.m_score = score;
+		}
+
+		if (stream.status() == QDataStream::Ok)
+			m_records.emplace(key, std::move(record));
+	}
+	m_clock = recordCount;
+}
+
+
+//-------------------------------------------------
+//  internalSave
+//-------------------------------------------------
+
+void IdentifyCache::internalSave(bool waitForOtherSave)
+{
+	// one save at a time
+	std::unique_lock saveLock(m_saveMutex, std::defer_lock);
+	if (waitForOtherSave)
+		saveLock.lock();
+	else if (!saveLock.try_lock())
+		return;
+
+	// take a snapshot of the records, and write it out without holding up finds and
+	// inserts on other threads
+	std::vector<std::pair<Key, Record>> records;
+	int unsavedCount;
+	{
+		std::lock_guard lock(m_mutex);
+		if (m_unsavedCount == 0)
+			return;
+		records.assign(m_records.begin(), m_records.end());
+		unsavedCount = m_unsavedCount;
+		m_unsavedCount = 0;
+	}
+
+	// records are written oldest first, so that load() can reconstruct the LRU order
+	std::ranges::sort(records, [](const auto &a, const auto &b)
+	{
+		return a.second.m_lastUsed < b.second.m_lastUsed;
+	});
+
+	bool success = false;
+	QDir().mkpath(QFileInfo(m_fileName).absolutePath());
+	QSaveFile file(m_fileName);
+	if (file.open(QIODevice::WriteOnly))
+	{
+		QDataStream stream(&file);
+		stream << s_magic << s_version << (quint64)m_formatSetFingerprint << (quint64)records.size();
+		for (const auto &[key, record] : records)
+		{
+			stream << (quint64)key.m_fileSize << (qint64)key.m_modifiedTime << (quint64)key.m_contentHash << (quint64)record.m_entries.size();
+			for (const Entry &entry : record.m_entries)
+				stream << entry.m_formatName << (quint8)entry.m_score;
+		}
+		success = file.commit();
+	}
+
+	// if that did not work, the records are still unsaved
+	if (!success)
+	{
+		std::lock_guard lock(m_mutex);
+		m_unsavedCount += unsavedCount;
+	}
+}
+
+
+//-------------------------------------------------
+//  trim - evict the least recently used records
+//-------------------------------------------------
+
+void IdentifyCache::trim()
+{
+	if (m_records.size() <= s_maximumRecords)
+		return;
+
+	// finding the oldest records means looking at all of them, so we evict in batches;
+	// that way, a long run of inserts only pays for it every so often
+	std::vector<std::uint64_t> lastUsed;
+	lastUsed.reserve(m_records.size());
+	for (const auto &pair : m_records)
+		lastUsed.push_back(pair.second.m_lastUsed);
+	auto newest = lastUsed.begin() + (m_records.size() - s_trimmedRecords - 1);
+	std::ranges::nth_element(lastUsed, newest);
+
+	// m_lastUsed values are unique, so this evicts exactly that many
+	std::uint64_t threshold = *newest;
+	std::erase_if(m_records, [threshold](const auto &pair)
+	{
+		return pair.second.m_lastUsed <= threshold;
+	});
+}
+
+
+//-------------------------------------------------
+//  KeyHash::operator()
+//-------------------------------------------------
+
+std::size_t IdentifyCache::KeyHash::operator()(const Key &key) const
+{
+	return std::hash<std::uint64_t>()(key.m_contentHash ^ (key.m_fileSize * 31) ^ ((std::uint64_t)key.m_modifiedTime * 17));
+}
@@ -0,0 +1,97 @@
+/***************************************************************************
+
+	identifycache.h
+
+	Persistent cache of identify() results
+
+***************************************************************************/
+
+#ifndef IDENTIFYCACHE_H
+#define IDENTIFYCACHE_H
+
+// Qt headers
+#include <QString>
+
+// C++ headers
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+
+class MappedFile;
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> IdentifyCache
+
+class IdentifyCache
+{
+public:
+	struct Key
+	{
+		std::uint64_t	m_fileSize;
+		std::int64_t	m_modifiedTime;
+		std::uint64_t	m_contentHash;
+
+		bool operator==(const Key &) const = default;
+	};
+
+	struct Entry
+	{
+		QString			m_formatName;
+		std::uint8_t	m_score;
+	};
+
+	// ctor/dtor
+	IdentifyCache(const QString &fileName, std::uint64_t formatSetFingerprint);
+	IdentifyCache(const IdentifyCache &) = delete;
+	IdentifyCache(IdentifyCache &&) = delete;
+	~IdentifyCache();
+
+	// statics
+	static QString defaultFileName();
+	static QString defaultScanFileName();
+	static std::optional<Key> keyForFile(const MappedFile &file);
+	static std::uint64_t hashBytes(std::span<const uint8_t> bytes, std::uint64_t hash = s_hashBasis);
+
+	// methods
+	std::optional<std::vector<Entry>> find(const Key &key);
+	void insert(const Key &key, std::vector<Entry> &&entries);
+	void save();
+
+	// constants
+	static constexpr std::uint64_t s_hashBasis = 0xCBF29CE484222325ULL;
+
+private:
+	struct KeyHash
+	{
+		std::size_t operator()(const Key &key) const;
+	};
+
+	struct Record
+	{
+		std::vector<Entry>	m_entries;
+		std::uint64_t		m_lastUsed;
+	};
+
+	QString										m_fileName;
+	std::uint64_t								m_formatSetFingerprint;
+	std::mutex									m_mutex;
+	std::mutex									m_saveMutex;
+	std::unordered_map<Key, Record, KeyHash>	m_records;
+	std::uint64_t								m_clock;
+	int											m_unsavedCount;
+
+	void load();
+	void internalSave(bool waitForOtherSave);
+	void trim();
+};
+
+
+#endif // IDENTIFYCACHE_H
@@ -0,0 +1,130 @@
+/***************************************************************************
+
+	identifyprefilter.cpp
+
+	Cheap signature checks used to narrow down identify() probes
+
+***************************************************************************/
+
+// qfloptool headers
+#include "identifyprefilter.h"
+
+// MAME headers
+#include "formats/flopimg.h"
+
+// C++ headers
+#include <algorithm>
+#include <cstring>
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+namespace
+{
+	struct KnownSignature
+	{
+		const char *		m_formatName;
+		std::uint32_t		m_offset;
+		std::string_view	m_bytes;
+	};
+};
+
+
+// Container formats whose identify() unconditionally rejects images lacking a magic
+// header; a format may be listed more than once, in which case any signature matches.
+// Formats not listed here (raw sector dumps and the like) are always probed.
+static const KnownSignature s_knownSignatures[] =
+{
+	{ "mfi",	0,	std::string_view("MESSFLOPPYIMAGE") },
+	{ "mfi",	0,	std::string_view("MAMEFLOPPYIMAGE") },
+	{ "hfe",	0,	std::string_view("HXCPICFE") },
+	{ "hfe",	0,	std::string_view("HXCHFEV3") },
+	{ "mfm",	0,	std::string_view("HXCMFM") },
+	{ "ipf",	0,	std::string_view("CAPS") },
+	{ "td0",	0,	std::string_view("TD") },
+	{ "td0",	0,	std::string_view("td") },
+	{ "imd",	0,	std::string_view("IMD ") },
+	{ "woz",	0,	std::string_view("WOZ1") },
+	{ "woz",	0,	std::string_view("WOZ2") },
+	{ "dsk",	0,	std::string_view("MV - CPC") },
+	{ "dsk",	0,	std::string_view("EXTENDED") },
+	{ "dfi",	0,	std::string_view("DFER") },
+	{ "dfi",	0,	std::string_view("DFE2") },
+	{ "86f",	0,	std::string_view("86BF") },
+	{ "cqm",	0,	std::string_view("CQ\x14", 3) },
+	{ "pasti",	0,	std::string_view("RSY\0", 4) },
+	{ "nfd",	0,	std::string_view("T98FDDIMAGE") }
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+IdentifyPrefilter::IdentifyPrefilter()
+{
+}
+
+
+//-------------------------------------------------
+//  clear
+//-------------------------------------------------
+
+void IdentifyPrefilter::clear()
+{
+	m_rules.clear();
+}
+
+
+//-------------------------------------------------
+//  addFormat
+//-------------------------------------------------
+
+void IdentifyPrefilter::addFormat(const floppy_image_format_t &mameFormat)
+{
+	for (const KnownSignature &knownSignature : s_knownSignatures)
+	{
+		if (!strcmp(knownSignature.m_formatName, mameFormat.name()))
+		{
+			Rule &rule = m_rules.try_emplace(&mameFormat, Rule{ {}, ~(std::uint64_t)0 }).first->second;
+			rule.m_signatures.push_back({ knownSignature.m_offset, knownSignature.m_bytes });
+
+			// an image too small to hold any of the signatures cannot be this format
+			std::uint64_t signatureEnd = knownSignature.m_offset + knownSignature.m_bytes.size();
+			rule.m_minimumSize = std::min(rule.m_minimumSize, signatureEnd);
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  isCandidate
+//-------------------------------------------------
+
+bool IdentifyPrefilter::isCandidate(const floppy_image_format_t &mameFormat, std::span<const uint8_t> bytes) const
+{
+	// empty files are never identified as anything
+	if (bytes.empty())
+		return false;
+
+	// formats without a rule always need to be probed
+	auto iter = m_rules.find(&mameFormat);
+	if (iter == m_rules.end())
+		return true;
+
+	const Rule &rule = iter->second;
+	if (bytes.size() < rule.m_minimumSize)
+		return false;
+
+	return std::ranges::any_of(rule.m_signatures, [bytes](const Signature &signature)
+	{
+		return signature.m_offset + signature.m_bytes.size() <= bytes.size()
+			&& !memcmp(bytes.data() + signature.m_offset, signature.m_bytes.data(), signature.m_bytes.size());
+	});
+}
@@ -0,0 +1,59 @@
+/***************************************************************************
+
+	identifyprefilter.h
+
+	Cheap signature checks used to narrow down identify() probes
+
+***************************************************************************/
+
+#ifndef IDENTIFYPREFILTER_H
+#define IDENTIFYPREFILTER_H
+
+// C++ headers
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+// MAME forward declarations
+class floppy_image_format_t;
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> IdentifyPrefilter
+
+class IdentifyPrefilter
+{
+public:
+	// ctor
+	IdentifyPrefilter();
+
+	// methods
+	void clear();
+	void addFormat(const floppy_image_format_t &mameFormat);
+	bool isCandidate(const floppy_image_format_t &mameFormat, std::span<const uint8_t> bytes) const;
+	std::size_t ruleCount() const { return m_rules.size(); }
+
+private:
+	struct Signature
+	{
+		std::uint32_t		m_offset;
+		std::string_view	m_bytes;
+	};
+
+	struct Rule
+	{
+		std::vector<Signature>	m_signatures;
+		std::uint64_t			m_minimumSize;
+	};
+
+	std::unordered_map<const floppy_image_format_t *, Rule>	m_rules;
+};
+
+
+#endif // IDENTIFYPREFILTER_H
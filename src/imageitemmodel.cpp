@@ -1,553 +1,1181 @@
-/***************************************************************************
-
-	imageitemmodel.cpp
-
-	QAbstractItemModel implementation for an image
-
-***************************************************************************/
-
-// qfloptool headers
-#include "imageitemmodel.h"
-
-// MAME headers
-#include "formats/fsmgr.h"
-
-// Qt headers
-#include <QDir>
-#include <QFont>
-
-
-//**************************************************************************
-//  TYPE DEFINITIONS
-//**************************************************************************
-
-struct ImageItemModel::DirectoryEntry
-{
-	EntryType					m_type;
-	std::string					m_name;
-	int							m_directoryIndex;
-	fs::meta_data				m_metadata;
-	bool						m_isExpanded;
-};
-
-struct ImageItemModel::Directory
-{
-	int							m_parentIndex;
-	int							m_parentEntryIndex;
-	std::vector<DirectoryEntry>	m_children;
-};
-
-struct ImageItemModel::Info
-{
-	std::vector<fs::meta_name>	m_metaNames;
-	std::vector<Directory>		m_directories;
-};
-
-
-//**************************************************************************
-//  IMPLEMENTATION
-//**************************************************************************
-
-//-------------------------------------------------
-//  loadIcon
-//-------------------------------------------------
-
-static QPixmap loadIcon(const QString &resourceName)
-{
-	// instantiate the QPixmap
-	QPixmap pixmap(resourceName);
-
-	// size it accordingly
-	QSize size(16, 16);
-	qreal xScaleFactor = pixmap.width() / (qreal)size.width();
-	qreal yScaleFactor = pixmap.height() / (qreal)size.height();
-	qreal scaleFactor = std::max(xScaleFactor, yScaleFactor);
-	pixmap.setDevicePixelRatio(scaleFactor);
-
-	// and return it
-	return pixmap;
-}
-
-
-//-------------------------------------------------
-//  ctor
-//-------------------------------------------------
-
-ImageItemModel::ImageItemModel(Floptool::Image::ptr &&image, QObject *parent)
-	: QAbstractItemModel(parent)
-	, m_image(std::move(image))
-	, m_fileIcon(loadIcon(":/resources/file.png"))
-	, m_folderIcon(loadIcon(":/resources/folder.png"))
-	, m_folderOpenIcon(loadIcon(":/resources/folder_open.png"))
-{
-	// allocate internal info
-	m_info = std::make_unique<Info>();
-
-	// load the directory
-	loadDirectory(-1, -1);
-
-	// identify all metadata
-	m_info->m_metaNames.reserve(64);
-	for (const fs::meta_description &desc : m_image->fileSystem().mameManager().file_meta_description())
-	{
-		m_info->m_metaNames.push_back(desc.m_name);
-	}
-	for (const fs::meta_description &desc : m_image->fileSystem().mameManager().directory_meta_description())
-	{
-		if (std::ranges::find(m_info->m_metaNames, desc.m_name) == m_info->m_metaNames.end())
-			m_info->m_metaNames.push_back(desc.m_name);
-	}
-	m_info->m_metaNames.shrink_to_fit();
-}
-
-
-//-------------------------------------------------
-//  dtor
-//-------------------------------------------------
-
-ImageItemModel::~ImageItemModel()
-{
-}
-
-
-//-------------------------------------------------
-//  loadDirectory
-//-------------------------------------------------
-
-int ImageItemModel::loadDirectory(int parentIndex, int parentEntryIndex)
-{
-	// sanity checks
-	assert(m_image);
-
-	int newDirectoryIndex = m_info->m_directories.size();
-	Directory &newDirectory = m_info->m_directories.emplace_back();
-	newDirectory.m_parentIndex = parentIndex;
-	newDirectory.m_parentEntryIndex = parentEntryIndex;
-
-	std::vector<std::string> path;
-	appendDirectoryPath(path, newDirectoryIndex);
-	auto dirContents = m_image->mameFileSystem().directory_contents(path);
-
-	newDirectory.m_children.reserve(dirContents.second.size());
-	for (auto &mameChild : dirContents.second)
-	{
-		// load metadata
-		std::vector<std::string> childPath = path;
-		childPath.push_back(std::move(mameChild.m_name));
-		auto metadataResult = m_image->mameFileSystem().metadata(childPath);
-
-		// create child entry
-		DirectoryEntry &child = newDirectory.m_children.emplace_back();
-		switch (mameChild.m_type)
-		{
-		case fs::dir_entry_type::file:
-			child.m_type = EntryType::File;
-			break;
-		case fs::dir_entry_type::dir:
-			child.m_type = EntryType::Directory;
-			break;
-		default:
-			throw false;
-		}
-
-		// set up child
-		child.m_name = std::move(childPath[childPath.size() - 1]);
-		child.m_directoryIndex = -1;
-		child.m_metadata = std::move(metadataResult.second);
-		child.m_isExpanded = false;
-	}
-
-	if (parentIndex >= 0 && parentEntryIndex >= 0)
-		m_info->m_directories[parentIndex].m_children[parentEntryIndex].m_directoryIndex = newDirectoryIndex;
-	return newDirectoryIndex;
-}
-
-
-//-------------------------------------------------
-//  appendDirectoryPath
-//-------------------------------------------------
-
-void ImageItemModel::appendDirectoryPath(std::vector<std::string> &path, int directoryIndex) const
-{
-	if (directoryIndex > 0)
-	{
-		int parentIndex = m_info->m_directories[directoryIndex].m_parentIndex;
-		int parentEntryIndex = m_info->m_directories[directoryIndex].m_parentEntryIndex;
-		appendDirectoryPath(path, parentIndex);
-		path.push_back(m_info->m_directories[parentIndex].m_children[parentEntryIndex].m_name);
-	}
-}
-
-
-//-------------------------------------------------
-//  loadItem
-//-------------------------------------------------
-
-void ImageItemModel::loadItem(const QModelIndex &index)
-{
-	DirectoryEntry *parentDirectoryEntry = findDirectoryEntry(index);
-	if (parentDirectoryEntry && parentDirectoryEntry->m_type == EntryType::Directory && parentDirectoryEntry->m_directoryIndex < 0)
-	{
-		parentDirectoryEntry->m_directoryIndex = loadDirectory(index.internalId(), index.row());
-		emit dataChanged(index, index);
-	}
-}
-
-
-//-------------------------------------------------
-//  setExpanded
-//-------------------------------------------------
-
-void ImageItemModel::setExpanded(const QModelIndex &index, bool expanded)
-{
-	DirectoryEntry *directoryEntry = findDirectoryEntry(index);
-	if (directoryEntry && expanded != directoryEntry->m_isExpanded)
-	{
-		directoryEntry->m_isExpanded = expanded;
-		emit dataChanged(index, index, { Qt::DecorationRole });
-	}
-}
-
-
-//-------------------------------------------------
-//  detachImage
-//-------------------------------------------------
-
-Floptool::Image::ptr ImageItemModel::detachImage()
-{
-	assert(m_image);
-	return std::move(m_image);
-}
-
-
-//-------------------------------------------------
-//  findDirectoryEntry
-//-------------------------------------------------
-
-const ImageItemModel::DirectoryEntry *ImageItemModel::findDirectoryEntry(const QModelIndex &index) const
-{
-	const DirectoryEntry *result = nullptr;
-	if (index.isValid())
-	{
-		const Directory &parentDirectory = m_info->m_directories[index.internalId()];
-		const DirectoryEntry &directoryEntry = parentDirectory.m_children[index.row()];
-		result = &directoryEntry;
-	}
-	return result;
-}
-
-
-//-------------------------------------------------
-//  findDirectoryEntry
-//-------------------------------------------------
-
-ImageItemModel::DirectoryEntry *ImageItemModel::findDirectoryEntry(const QModelIndex &index)
-{
-	const ImageItemModel &constThis = *this;
-	return const_cast<DirectoryEntry *>(constThis.findDirectoryEntry(index));
-}
-
-
-//-------------------------------------------------
-//  convert
-//-------------------------------------------------
-
-QString ImageItemModel::convert(std::string_view s) const
-{
-	return m_image->convert(s);
-}
-
-
-//-------------------------------------------------
-//  textAlignmentFromMetaType
-//-------------------------------------------------
-
-static Qt::AlignmentFlag textAlignmentFromMetaType(fs::meta_type type)
-{
-	Qt::AlignmentFlag result;
-	switch (type)
-	{
-	case fs::meta_type::number:
-		result = Qt::AlignmentFlag::AlignRight;
-		break;
-	case fs::meta_type::date:
-	case fs::meta_type::flag:
-	case fs::meta_type::string:
-	default:
-		result = Qt::AlignmentFlag::AlignLeft;
-		break;
-	}
-	return result;
-}
-
-
-//-------------------------------------------------
-//  iconFromDirectoryEntry
-//-------------------------------------------------
-
-QPixmap ImageItemModel::iconFromDirectoryEntry(const DirectoryEntry &directoryEntry) const
-{
-	QPixmap result;
-	switch (directoryEntry.m_type)
-	{
-	case EntryType::File:
-		result = m_fileIcon;
-		break;
-	case EntryType::Directory:
-		result = directoryEntry.m_isExpanded ? m_folderOpenIcon : m_folderIcon;
-		break;
-	default:
-		throw false;
-	}
-	return result;
-}
-
-
-//-------------------------------------------------
-//  fileName
-//-------------------------------------------------
-
-QString ImageItemModel::fileName(const QModelIndex &index) const
-{
-	const DirectoryEntry *entry = findDirectoryEntry(index);
-	return entry
-		? convert(entry->m_name)
-		: "";
-}
-
-
-//-------------------------------------------------
-//  pathFromModelIndex
-//-------------------------------------------------
-
-std::vector<std::string> ImageItemModel::pathFromModelIndex(const QModelIndex &index, int &directoryIndex, int &directoryEntryIndex) const
-{
-	std::vector<std::string> result;
-
-	// look up the directory entry
-	if (index.isValid())
-	{
-		directoryIndex = index.internalId();
-		directoryEntryIndex = index.row();
-		const DirectoryEntry &directoryEntry = m_info->m_directories[directoryIndex].m_children[directoryEntryIndex];
-
-		// determine the path
-		appendDirectoryPath(result, index.internalId());
-		result.push_back(directoryEntry.m_name);
-	}
-	return result;
-}
-
-
-//-------------------------------------------------
-//  readFile
-//-------------------------------------------------
-
-std::optional<std::vector<uint8_t>> ImageItemModel::readFile(const QModelIndex &index) const
-{
-	// determine the path
-	int directoryIndex, directoryEntryIndex;
-	std::vector<std::string> pathOnImage = pathFromModelIndex(index, directoryIndex, directoryEntryIndex);
-	return m_image->readFile(pathOnImage);
-}
-
-
-//-------------------------------------------------
-//  extract
-//-------------------------------------------------
-
-void ImageItemModel::extract(const QModelIndex &index, const QString &path, bool appendImageFileName)
-{
-	// determine the path
-	int directoryIndex, directoryEntryIndex;
-	std::vector<std::string> pathOnImage = pathFromModelIndex(index, directoryIndex, directoryEntryIndex);
-	if (pathOnImage.empty())
-		return;
-
-	// recursively extract the image
-	internalExtract(pathOnImage, directoryIndex, directoryEntryIndex,
-		appendImageFileName ? QString("%1/%2").arg(path, convert(pathOnImage[pathOnImage.size() - 1])) : path);
-}
-
-
-//-------------------------------------------------
-//  internalExtract
-//-------------------------------------------------
-
-void ImageItemModel::internalExtract(std::vector<std::string> &pathOnImage, int directoryIndex, int directoryEntryIndex, const QString &path)
-{
-	const DirectoryEntry &directoryEntry = m_info->m_directories[directoryIndex].m_children[directoryEntryIndex];
-	switch (directoryEntry.m_type)
-	{
-	case EntryType::File:
-		{
-			// this a file; get the bytes off the image
-			auto bytes = m_image->readFile(pathOnImage);
-			if (!bytes)
-				return;
-
-			// and write it locally
-			QFile file(path);
-			if (file.open(QIODevice::WriteOnly))
-				file.write((const char *) &(*bytes)[0], bytes->size());
-		}
-		break;
-
-	case EntryType::Directory:
-		// this is a directory; first thing we need to do is create the local directory
-		if (!QDir(path).exists() && !QDir().mkdir(path))
-			return;
-
-		// the entry needs to be loaded
-		if (directoryEntry.m_directoryIndex < 0)
-			loadDirectory(directoryIndex, directoryEntryIndex);
-		assert(directoryEntry.m_directoryIndex >= 0);
-
-		// recursively extract
-		for (int childIndex = 0; childIndex < m_info->m_directories[directoryEntry.m_directoryIndex].m_children.size(); childIndex++)
-		{
-			const DirectoryEntry &childEntry = m_info->m_directories[directoryEntry.m_directoryIndex].m_children[childIndex];
-			pathOnImage.push_back(childEntry.m_name);
-			internalExtract(pathOnImage, directoryEntry.m_directoryIndex, childIndex, path + "/" + convert(childEntry.m_name));
-			pathOnImage.resize(pathOnImage.size() - 1);
-		}
-		break;
-
-	default:
-		throw false;
-	}
-}
-
-
-//-------------------------------------------------
-//  index
-//-------------------------------------------------
-
-QModelIndex ImageItemModel::index(int row, int column, const QModelIndex &parent) const
-{
-	const DirectoryEntry *parentDirectoryEntry = findDirectoryEntry(parent);
-	return createIndex(row, column, parentDirectoryEntry ? parentDirectoryEntry->m_directoryIndex : 0);
-}
-
-
-//-------------------------------------------------
-//  parent
-//-------------------------------------------------
-
-QModelIndex ImageItemModel::parent(const QModelIndex &child) const
-{
-	const Directory &directory = m_info->m_directories[child.internalId()];
-	return directory.m_parentIndex >= 0 && directory.m_parentEntryIndex >= 0
-		? createIndex(directory.m_parentEntryIndex, 0, directory.m_parentIndex)
-		: QModelIndex();
-}
-
-
-//-------------------------------------------------
-//  rowCount
-//-------------------------------------------------
-
-int ImageItemModel::rowCount(const QModelIndex &parent) const
-{
-	const DirectoryEntry *parentDirectoryEntry = findDirectoryEntry(parent);
-	int parentDirectoryIndex = parentDirectoryEntry ? parentDirectoryEntry->m_directoryIndex : 0;
-	return parentDirectoryIndex >= 0
-		? m_info->m_directories[parentDirectoryIndex].m_children.size()
-		: 0;
-}
-
-
-//-------------------------------------------------
-//  columnCount
-//-------------------------------------------------
-
-int ImageItemModel::columnCount(const QModelIndex &parent) const
-{
-	return m_info->m_metaNames.size();
-}
-
-
-//-------------------------------------------------
-//  hasChildren
-//-------------------------------------------------
-
-bool ImageItemModel::hasChildren(const QModelIndex &parent) const
-{
-	return rowCount(parent) > 0;
-}
-
-
-//-------------------------------------------------
-//  flags
-//-------------------------------------------------
-
-Qt::ItemFlags ImageItemModel::flags(const QModelIndex &index) const
-{
-	return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
-}
-
-
-//-------------------------------------------------
-//  headerData
-//-------------------------------------------------
-
-QVariant ImageItemModel::headerData(int section, Qt::Orientation orientation, int role) const
-{
-	QVariant result;
-	if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
-	{
-		switch (role)
-		{
-		case Qt::DisplayRole:
-			{
-				fs::meta_name name = m_info->m_metaNames[section];
-				const char *name_str = fs::meta_data::entry_name(name);
-				result = convert(name_str);
-			}
-			break;
-
-		case Qt::FontRole:
-			{
-				QFont font;
-				font.setUnderline(true);
-				result = std::move(font);
-			}
-			break;
-		}
-	}
-	return result;
-}
-
-
-//-------------------------------------------------
-//  data
-//-------------------------------------------------
-
-QVariant ImageItemModel::data(const QModelIndex &index, int role) const
-{
-	QVariant result;
-	const DirectoryEntry *directoryEntry = findDirectoryEntry(index);
-	if (directoryEntry)
-	{
-		fs::meta_name name = m_info->m_metaNames[index.column()];
-		switch (role)
-		{
-		case Qt::DisplayRole:
-			{
-				std::string value = directoryEntry->m_metadata.get_string(name);
-				result = convert(value);
-			}
-			break;
-
-		case Qt::TextAlignmentRole:
-			result = textAlignmentFromMetaType(directoryEntry->m_metadata.get(name).type());
-			break;
-
-		case Qt::DecorationRole:
-			if (index.column() == 0)
-				result = iconFromDirectoryEntry(*directoryEntry);
-			break;
-		}
-	}
-	return result;
-}
+/***************************************************************************
+
+	imageitemmodel.cpp
+
+	QAbstractItemModel implementation for an image
+
+***************************************************************************/
+
+// qfloptool headers
+#include "imageitemmodel.h"
+
+// MAME headers
+#include "formats/fsmgr.h"
+
+// Qt headers
+#include <QCollator>
+#include <QFont>
+#include <QtConcurrent>
+
+// C++ headers
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <tuple>
+
+
+//**************************************************************************
+//  TYPE DEFINITIONS
+//**************************************************************************
+
+// one link of a path; the name is a copy rather than a StringRef, because the prefetch
+// worker reads paths while the GUI thread grows the string arena
+struct ImageItemModel::PathNode
+{
+	PathHandle					m_parent;
+	std::string					m_name;
+};
+
+// a string within Info::m_stringArena
+struct ImageItemModel::StringRef
+{
+	uint32_t					m_offset;
+	uint32_t					m_length;
+};
+
+// one metadata column, indexed by entry; only the array matching m_type is populated
+struct ImageItemModel::MetaColumn
+{
+	fs::meta_type				m_type;
+	Qt::AlignmentFlag			m_textAlignment;
+	std::vector<bool>			m_isPresent;
+	std::vector<uint64_t>		m_numbers;		// numbers and flags
+	std::vector<StringRef>		m_strings;
+	std::vector<util::arbitrary_datetime>	m_dates;	// as MAME reported them; not necessarily valid dates
+
+	// display text, formatted the first time a view asks for it
+	std::vector<bool>			m_isDisplayTextCached;
+	std::vector<QString>		m_displayTexts;
+
+	// collation keys for string columns, built the first time we sort on this column
+	std::vector<QCollatorSortKey>	m_sortKeys;
+};
+
+struct ImageItemModel::Directory
+{
+	int							m_parentIndex;
+	int							m_parentEntryIndex;
+	int							m_firstEntryIndex;	// children are contiguous in the entry arrays
+	int							m_entryCount;
+	std::vector<int>			m_rows;				// directory entry indexes, in the order presented
+	PathHandle					m_path;				// null for the root
+};
+
+struct ImageItemModel::Info
+{
+	std::vector<fs::meta_name>	m_metaNames;
+	std::vector<Directory>		m_directories;
+
+	// entries of all directories, in the order they were loaded
+	std::string					m_stringArena;
+	std::vector<EntryType>		m_entryTypes;
+	std::vector<StringRef>		m_entryNames;
+	std::vector<int>			m_entryParentIndexes;		// the directory holding the entry
+	std::vector<int>			m_entryDirectoryIndexes;	// the directory the entry was loaded into, if any
+	std::vector<bool>			m_entryIsExpanded;
+	std::vector<int>			m_entryRows;				// row within the parent directory; -1 if filtered out
+	std::vector<MetaColumn>		m_metaColumns;				// parallel to m_metaNames
+
+	// how rows are presented
+	int							m_sortColumn = -1;			// -1 for the order on the image
+	Qt::SortOrder				m_sortOrder = Qt::AscendingOrder;
+	QString						m_filterText;				// case folded
+	QCollator					m_collator;
+	std::vector<QString>		m_entryFilterKeys;			// case folded names, built the first time we filter
+
+	StringRef addString(std::string_view s)
+	{
+		StringRef result = { (uint32_t)m_stringArena.size(), (uint32_t)s.size() };
+		m_stringArena.append(s);
+		return result;
+	}
+
+	std::string_view string(const StringRef &ref) const
+	{
+		return std::string_view(m_stringArena).substr(ref.m_offset, ref.m_length);
+	}
+};
+
+struct ImageItemModel::Prefetcher
+{
+	struct Request
+	{
+		int							m_directoryIndex;
+		int							m_directoryEntryIndex;
+		PathHandle					m_path;
+	};
+
+	struct Result
+	{
+		int							m_directoryIndex;
+		int							m_directoryEntryIndex;
+		PathHandle					m_path;
+		std::vector<fs::dir_entry>	m_entries;
+	};
+
+	std::unique_ptr<fs::filesystem_t>	m_fileSystem;		// snapshot; only touched by the worker
+	std::mutex							m_mutex;
+	std::deque<Request>					m_queue;			// visible directories first
+	std::vector<Result>					m_results;
+	bool								m_isRunning = false;
+	bool								m_isPublishPending = false;
+	std::atomic<bool>					m_isCancelled = false;
+	QFuture<void>						m_future;
+};
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  loadIcon
+//-------------------------------------------------
+
+static QPixmap loadIcon(const QString &resourceName)
+{
+	// instantiate the QPixmap
+	QPixmap pixmap(resourceName);
+
+	// size it accordingly
+	QSize size(16, 16);
+	qreal xScaleFactor = pixmap.width() / (qreal)size.width();
+	qreal yScaleFactor = pixmap.height() / (qreal)size.height();
+	qreal scaleFactor = std::max(xScaleFactor, yScaleFactor);
+	pixmap.setDevicePixelRatio(scaleFactor);
+
+	// and return it
+	return pixmap;
+}
+
+
+//-------------------------------------------------
+//  textAlignmentFromMetaType
+//-------------------------------------------------
+
+static Qt::AlignmentFlag textAlignmentFromMetaType(fs::meta_type type)
+{
+	Qt::AlignmentFlag result;
+	switch (type)
+	{
+	case fs::meta_type::number:
+		result = Qt::AlignmentFlag::AlignRight;
+		break;
+	case fs::meta_type::date:
+	case fs::meta_type::flag:
+	case fs::meta_type::string:
+	default:
+		result = Qt::AlignmentFlag::AlignLeft;
+		break;
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+ImageItemModel::ImageItemModel(Floptool::Image::ptr &&image, QObject *parent)
+	: QAbstractItemModel(parent)
+	, m_image(std::move(image))
+	, m_fileIcon(loadIcon(":/resources/file.png"))
+	, m_folderIcon(loadIcon(":/resources/folder.png"))
+	, m_folderOpenIcon(loadIcon(":/resources/folder_open.png"))
+{
+	// allocate internal info; names sort the way a person would expect ("FILE2" before "file10")
+	m_info = std::make_unique<Info>();
+	m_info->m_collator.setCaseSensitivity(Qt::CaseInsensitive);
+	m_info->m_collator.setNumericMode(true);
+
+	// subdirectories are loaded in the background against a snapshot of the file system,
+	// so that the primary instance remains ours; if we cannot get a snapshot, we do without
+	m_prefetcher = std::make_unique<Prefetcher>();
+	try
+	{
+		m_prefetcher->m_fileSystem = m_image->createSnapshot();
+	}
+	catch (...)
+	{
+	}
+	if (!m_prefetcher->m_fileSystem)
+		m_prefetcher.reset();
+
+	// identify all metadata; this has to happen before loading anything, because each
+	// piece of metadata gets a column of its own
+	m_info->m_metaNames.reserve(64);
+	m_info->m_metaColumns.reserve(64);
+	auto addMetaColumn = [this](const fs::meta_description &desc)
+	{
+		if (std::ranges::find(m_info->m_metaNames, desc.m_name) == m_info->m_metaNames.end())
+		{
+			m_info->m_metaNames.push_back(desc.m_name);
+			MetaColumn &column = m_info->m_metaColumns.emplace_back();
+			column.m_type = desc.m_type;
+			column.m_textAlignment = textAlignmentFromMetaType(desc.m_type);
+		}
+	};
+	for (const fs::meta_description &desc : m_image->fileSystem().mameManager().file_meta_description())
+		addMetaColumn(desc);
+	for (const fs::meta_description &desc : m_image->fileSystem().mameManager().directory_meta_description())
+		addMetaColumn(desc);
+	m_info->m_metaNames.shrink_to_fit();
+	m_info->m_metaColumns.shrink_to_fit();
+
+	// load the directory
+	loadDirectory(-1, -1);
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+ImageItemModel::~ImageItemModel()
+{
+	stopPrefetch();
+	stopSearchIndex();
+}
+
+
+//-------------------------------------------------
+//  loadDirectory
+//-------------------------------------------------
+
+int ImageItemModel::loadDirectory(int parentIndex, int parentEntryIndex)
+{
+	// sanity checks
+	assert(m_image);
+
+	// get the directory contents and metadata in one pass
+	PathHandle path = parentIndex >= 0 && parentEntryIndex >= 0
+		? entryPath(parentIndex, parentEntryIndex)
+		: PathHandle();
+	std::vector<fs::dir_entry> dirContents = m_image->directoryContents(expandPath(path)).value_or(std::vector<fs::dir_entry>());
+
+	// add it, and get a head start on its subdirectories
+	int newDirectoryIndex = addDirectory(parentIndex, parentEntryIndex, std::move(path), std::move(dirContents));
+	enqueueSubdirectoryPrefetches(newDirectoryIndex);
+	return newDirectoryIndex;
+}
+
+
+//-------------------------------------------------
+//  addDirectory
+//-------------------------------------------------
+
+int ImageItemModel::addDirectory(int parentIndex, int parentEntryIndex, PathHandle &&path, std::vector<fs::dir_entry> &&entries)
+{
+	int newDirectoryIndex = m_info->m_directories.size();
+	int firstEntryIndex = m_info->m_entryTypes.size();
+	m_info->m_directories.push_back({ parentIndex, parentEntryIndex, firstEntryIndex, (int)entries.size(), std::vector<int>(), std::move(path) });
+
+	// grow all of the columns up front
+	std::size_t newEntryCount = firstEntryIndex + entries.size();
+	m_info->m_entryParentIndexes.resize(newEntryCount, newDirectoryIndex);
+	m_info->m_entryDirectoryIndexes.resize(newEntryCount, -1);
+	m_info->m_entryIsExpanded.resize(newEntryCount, false);
+	m_info->m_entryRows.resize(newEntryCount, -1);
+	for (MetaColumn &column : m_info->m_metaColumns)
+	{
+		column.m_isPresent.resize(newEntryCount, false);
+		column.m_isDisplayTextCached.resize(newEntryCount, false);
+		column.m_displayTexts.resize(newEntryCount);
+		switch (column.m_type)
+		{
+		case fs::meta_type::string:
+			column.m_strings.resize(newEntryCount, StringRef{ 0, 0 });
+			break;
+		case fs::meta_type::date:
+			column.m_dates.resize(newEntryCount, util::arbitrary_datetime());
+			break;
+		default:
+			column.m_numbers.resize(newEntryCount, 0);
+			break;
+		}
+	}
+
+	for (int i = 0; i < (int)entries.size(); i++)
+	{
+		const fs::dir_entry &mameChild = entries[i];
+		int childIndex = firstEntryIndex + i;
+
+		// create child entry
+		switch (mameChild.m_type)
+		{
+		case fs::dir_entry_type::file:
+			m_info->m_entryTypes.push_back(EntryType::File);
+			break;
+		case fs::dir_entry_type::dir:
+			m_info->m_entryTypes.push_back(EntryType::Directory);
+			break;
+		default:
+			throw false;
+		}
+		m_info->m_entryNames.push_back(m_info->addString(mameChild.m_name));
+
+		// and spread its metadata across the columns
+		for (std::size_t columnIndex = 0; columnIndex < m_info->m_metaColumns.size(); columnIndex++)
+		{
+			MetaColumn &column = m_info->m_metaColumns[columnIndex];
+			fs::meta_name name = m_info->m_metaNames[columnIndex];
+			if (!mameChild.m_meta.has(name) || mameChild.m_meta.get(name).type() != column.m_type)
+				continue;
+
+			const fs::meta_value &value = mameChild.m_meta.get(name);
+			switch (column.m_type)
+			{
+			case fs::meta_type::string:
+				column.m_strings[childIndex] = m_info->addString(value.as_string());
+				break;
+			case fs::meta_type::number:
+				column.m_numbers[childIndex] = value.as_number();
+				break;
+			case fs::meta_type::flag:
+				column.m_numbers[childIndex] = value.as_flag() ? 1 : 0;
+				break;
+			case fs::meta_type::date:
+				column.m_dates[childIndex] = value.as_date();
+				break;
+			}
+			column.m_isPresent[childIndex] = true;
+		}
+	}
+
+	arrangeRows(newDirectoryIndex);
+
+	// nothing is visible until the parent points at the new directory; the root is set up
+	// before anybody is looking, and everything else appears as new rows
+	if (parentIndex >= 0 && parentEntryIndex >= 0)
+	{
+		int parentEntryRow = m_info->m_entryRows[findEntry(parentIndex, parentEntryIndex)];
+		int rowCount = (int)m_info->m_directories[newDirectoryIndex].m_rows.size();
+		bool notify = parentEntryRow >= 0 && rowCount > 0;
+		if (notify)
+			beginInsertRows(createIndex(parentEntryRow, 0, parentIndex), 0, rowCount - 1);
+		m_info->m_entryDirectoryIndexes[findEntry(parentIndex, parentEntryIndex)] = newDirectoryIndex;
+		if (notify)
+			endInsertRows();
+	}
+	return newDirectoryIndex;
+}
+
+
+//-------------------------------------------------
+//  prefetch
+//-------------------------------------------------
+
+void ImageItemModel::prefetch(const QModelIndexList &visibleIndexes)
+{
+	// visible directories jump the queue; walk backwards so that they end up in
+	// top-to-bottom order at the front
+	for (auto iter = visibleIndexes.rbegin(); iter != visibleIndexes.rend(); iter++)
+	{
+		if (iter->isValid() && iter->column() == 0)
+			enqueuePrefetch((int)iter->internalId(), directoryEntryIndex(*iter), true);
+	}
+}
+
+
+//-------------------------------------------------
+//  enqueueSubdirectoryPrefetches
+//-------------------------------------------------
+
+void ImageItemModel::enqueueSubdirectoryPrefetches(int directoryIndex)
+{
+	for (int childIndex = 0; childIndex < m_info->m_directories[directoryIndex].m_entryCount; childIndex++)
+		enqueuePrefetch(directoryIndex, childIndex, false);
+}
+
+
+//-------------------------------------------------
+//  enqueuePrefetch
+//-------------------------------------------------
+
+void ImageItemModel::enqueuePrefetch(int directoryIndex, int directoryEntryIndex, bool prioritize)
+{
+	int entryIndex = findEntry(directoryIndex, directoryEntryIndex);
+	if (!m_prefetcher || m_info->m_entryTypes[entryIndex] != EntryType::Directory || m_info->m_entryDirectoryIndexes[entryIndex] >= 0)
+		return;
+
+	std::lock_guard lock(m_prefetcher->m_mutex);
+	auto iter = std::ranges::find_if(m_prefetcher->m_queue, [directoryIndex, directoryEntryIndex](const Prefetcher::Request &request)
+	{
+		return request.m_directoryIndex == directoryIndex && request.m_directoryEntryIndex == directoryEntryIndex;
+	});
+	if (iter != m_prefetcher->m_queue.end())
+	{
+		// already queued; move it up front if need be, path and all
+		if (!prioritize)
+			return;
+		Prefetcher::Request request = std::move(*iter);
+		m_prefetcher->m_queue.erase(iter);
+		m_prefetcher->m_queue.push_front(std::move(request));
+	}
+	else
+	{
+		Prefetcher::Request request = { directoryIndex, directoryEntryIndex, entryPath(directoryIndex, directoryEntryIndex) };
+		if (prioritize)
+			m_prefetcher->m_queue.push_front(std::move(request));
+		else
+			m_prefetcher->m_queue.push_back(std::move(request));
+	}
+
+	// start the worker if it is not already going
+	if (!m_prefetcher->m_isRunning)
+	{
+		m_prefetcher->m_isRunning = true;
+		m_prefetcher->m_future = QtConcurrent::run([this]
+		{
+			prefetchWorker();
+		});
+	}
+}
+
+
+//-------------------------------------------------
+//  prefetchWorker
+//-------------------------------------------------
+
+void ImageItemModel::prefetchWorker()
+{
+	for (;;)
+	{
+		Prefetcher::Request request;
+		{
+			std::lock_guard lock(m_prefetcher->m_mutex);
+			if (m_prefetcher->m_isCancelled || m_prefetcher->m_queue.empty())
+			{
+				m_prefetcher->m_isRunning = false;
+				return;
+			}
+			request = std::move(m_prefetcher->m_queue.front());
+			m_prefetcher->m_queue.pop_front();
+		}
+
+		// load the directory off of the snapshot
+		std::optional<std::vector<fs::dir_entry>> entries;
+		try
+		{
+			entries = Floptool::Image::directoryContents(*m_prefetcher->m_fileSystem, expandPath(request.m_path));
+		}
+		catch (...)
+		{
+			// MAME file system code can throw on corrupt images; let the GUI thread find out
+			// for itself if the user ever opens this directory
+		}
+		if (!entries)
+			continue;
+
+		// queue the result up for the GUI thread; results that arrive while a publish is
+		// pending are batched into it
+		bool needsPublish;
+		{
+			std::lock_guard lock(m_prefetcher->m_mutex);
+			m_prefetcher->m_results.push_back({ request.m_directoryIndex, request.m_directoryEntryIndex, std::move(request.m_path), std::move(*entries) });
+			needsPublish = !m_prefetcher->m_isPublishPending;
+			m_prefetcher->m_isPublishPending = true;
+		}
+		if (needsPublish)
+		{
+			QMetaObject::invokeMethod(this, [this]
+			{
+				publishPrefetchResults();
+			}, Qt::QueuedConnection);
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  publishPrefetchResults
+//-------------------------------------------------
+
+void ImageItemModel::publishPrefetchResults()
+{
+	// we may have stopped prefetching since this was posted
+	if (!m_prefetcher)
+		return;
+
+	std::vector<Prefetcher::Result> results;
+	{
+		std::lock_guard lock(m_prefetcher->m_mutex);
+		results.swap(m_prefetcher->m_results);
+		m_prefetcher->m_isPublishPending = false;
+	}
+
+	for (Prefetcher::Result &result : results)
+	{
+		// the directory may have been loaded synchronously in the meantime
+		if (m_info->m_entryDirectoryIndexes[findEntry(result.m_directoryIndex, result.m_directoryEntryIndex)] < 0)
+			addDirectory(result.m_directoryIndex, result.m_directoryEntryIndex, std::move(result.m_path), std::move(result.m_entries));
+	}
+}
+
+
+//-------------------------------------------------
+//  stopPrefetch
+//-------------------------------------------------
+
+void ImageItemModel::stopPrefetch()
+{
+	if (m_prefetcher)
+	{
+		m_prefetcher->m_isCancelled = true;
+		m_prefetcher->m_future.waitForFinished();
+		m_prefetcher.reset();
+	}
+}
+
+
+//-------------------------------------------------
+//  searchIndex
+//-------------------------------------------------
+
+QFuture<SearchIndex::ptr> ImageItemModel::searchIndex()
+{
+	// the index is built on first request, off of a snapshot of its own so that it neither
+	// waits on nor holds up the prefetcher
+	if (!m_searchIndexFuture)
+	{
+		std::shared_ptr<fs::filesystem_t> fileSystem;
+		try
+		{
+			fileSystem = m_image->createSnapshot();
+		}
+		catch (...)
+		{
+		}
+
+		const Floptool::Image &image = *m_image;
+		m_searchIndexFuture = QtConcurrent::run([fileSystem, &image](QPromise<SearchIndex::ptr> &promise)
+		{
+			SearchIndex::ptr result;
+			try
+			{
+				if (fileSystem)
+					result = SearchIndex::build(*fileSystem, image, [&promise] { return promise.isCanceled(); });
+			}
+			catch (...)
+			{
+				// MAME file system code can throw on corrupt images; there is simply no index
+			}
+			promise.addResult(std::move(result));
+		});
+	}
+	return *m_searchIndexFuture;
+}
+
+
+//-------------------------------------------------
+//  stopSearchIndex
+//-------------------------------------------------
+
+void ImageItemModel::stopSearchIndex()
+{
+	// the build walks a snapshot over our image, so it has to be gone before the image is
+	if (m_searchIndexFuture)
+	{
+		m_searchIndexFuture->cancel();
+		m_searchIndexFuture->waitForFinished();
+		m_searchIndexFuture.reset();
+	}
+}
+
+
+//-------------------------------------------------
+//  indexFromPath
+//-------------------------------------------------
+
+QModelIndex ImageItemModel::indexFromPath(const std::vector<std::string> &path)
+{
+	// walk down from the root, loading only the directories along the way
+	int directoryIndex = 0;
+	int entryIndex = -1;
+	for (std::size_t i = 0; i < path.size(); i++)
+	{
+		if (i > 0)
+		{
+			if (m_info->m_entryTypes[entryIndex] != EntryType::Directory)
+				return QModelIndex();
+			if (m_info->m_entryDirectoryIndexes[entryIndex] < 0)
+				loadDirectory(directoryIndex, entryIndex - m_info->m_directories[directoryIndex].m_firstEntryIndex);
+			directoryIndex = m_info->m_entryDirectoryIndexes[entryIndex];
+		}
+
+		const Directory &directory = m_info->m_directories[directoryIndex];
+		entryIndex = -1;
+		for (int childIndex = 0; childIndex < directory.m_entryCount && entryIndex < 0; childIndex++)
+		{
+			if (entryName(directory.m_firstEntryIndex + childIndex) == path[i])
+				entryIndex = directory.m_firstEntryIndex + childIndex;
+		}
+		if (entryIndex < 0)
+			return QModelIndex();
+	}
+
+	// the entry may be filtered out
+	int row = entryIndex >= 0 ? m_info->m_entryRows[entryIndex] : -1;
+	return row >= 0
+		? createIndex(row, 0, directoryIndex)
+		: QModelIndex();
+}
+
+
+//-------------------------------------------------
+//  entryPath
+//-------------------------------------------------
+
+ImageItemModel::PathHandle ImageItemModel::entryPath(int directoryIndex, int directoryEntryIndex) const
+{
+	// one link onto the directory's own path; nothing above it is copied
+	std::string_view name = entryName(findEntry(directoryIndex, directoryEntryIndex));
+	return std::make_shared<const PathNode>(PathNode{ m_info->m_directories[directoryIndex].m_path, std::string(name) });
+}
+
+
+//-------------------------------------------------
+//  expandPath - builds the list of names MAME
+//	wants out of a path
+//-------------------------------------------------
+
+std::vector<std::string> ImageItemModel::expandPath(const PathHandle &path)
+{
+	std::vector<std::string> result;
+	for (const PathNode *node = path.get(); node; node = node->m_parent.get())
+		result.push_back(node->m_name);
+	std::ranges::reverse(result);
+	return result;
+}
+
+
+//-------------------------------------------------
+//  loadItem
+//-------------------------------------------------
+
+void ImageItemModel::loadItem(const QModelIndex &index)
+{
+	int parentEntryIndex = findEntry(index);
+	if (parentEntryIndex >= 0 && m_info->m_entryTypes[parentEntryIndex] == EntryType::Directory && m_info->m_entryDirectoryIndexes[parentEntryIndex] < 0)
+	{
+		loadDirectory(index.internalId(), directoryEntryIndex(index));
+		emit dataChanged(index, index);
+	}
+}
+
+
+//-------------------------------------------------
+//  setExpanded
+//-------------------------------------------------
+
+void ImageItemModel::setExpanded(const QModelIndex &index, bool expanded)
+{
+	int entryIndex = findEntry(index);
+	if (entryIndex >= 0 && expanded != m_info->m_entryIsExpanded[entryIndex])
+	{
+		m_info->m_entryIsExpanded[entryIndex] = expanded;
+		emit dataChanged(index, index, { Qt::DecorationRole });
+	}
+}
+
+
+//-------------------------------------------------
+//  setFilterText
+//-------------------------------------------------
+
+void ImageItemModel::setFilterText(const QString &text)
+{
+	QString filterText = text.toCaseFolded();
+	if (filterText != m_info->m_filterText)
+	{
+		m_info->m_filterText = std::move(filterText);
+		rearrangeAllRows();
+	}
+}
+
+
+//-------------------------------------------------
+//  sort
+//-------------------------------------------------
+
+void ImageItemModel::sort(int column, Qt::SortOrder order)
+{
+	if (column >= columnCount())
+		column = -1;
+	if (column != m_info->m_sortColumn || order != m_info->m_sortOrder)
+	{
+		m_info->m_sortColumn = column;
+		m_info->m_sortOrder = order;
+		rearrangeAllRows();
+	}
+}
+
+
+//-------------------------------------------------
+//  rearrangeAllRows
+//-------------------------------------------------
+
+void ImageItemModel::rearrangeAllRows()
+{
+	emit layoutAboutToBeChanged();
+
+	// remember what entries the views are holding on to
+	QModelIndexList oldPersistentIndexes = persistentIndexList();
+	std::vector<int> persistentEntryIndexes;
+	persistentEntryIndexes.reserve(oldPersistentIndexes.size());
+	for (const QModelIndex &index : oldPersistentIndexes)
+		persistentEntryIndexes.push_back(findEntry(index));
+
+	// rearrange everything we have loaded
+	for (int directoryIndex = 0; directoryIndex < (int)m_info->m_directories.size(); directoryIndex++)
+		arrangeRows(directoryIndex);
+
+	// and tell the views where those entries ended up
+	QModelIndexList newPersistentIndexes;
+	newPersistentIndexes.reserve(oldPersistentIndexes.size());
+	for (qsizetype i = 0; i < oldPersistentIndexes.size(); i++)
+	{
+		int entryIndex = persistentEntryIndexes[i];
+		int row = entryIndex >= 0 ? m_info->m_entryRows[entryIndex] : -1;
+		newPersistentIndexes.push_back(row >= 0
+			? createIndex(row, oldPersistentIndexes[i].column(), m_info->m_entryParentIndexes[entryIndex])
+			: QModelIndex());
+	}
+	changePersistentIndexList(oldPersistentIndexes, newPersistentIndexes);
+
+	emit layoutChanged();
+}
+
+
+//-------------------------------------------------
+//  arrangeRows
+//-------------------------------------------------
+
+void ImageItemModel::arrangeRows(int directoryIndex)
+{
+	Directory &directory = m_info->m_directories[directoryIndex];
+
+	// filter; directories always stay, so that whatever matches within them can be found
+	if (!m_info->m_filterText.isEmpty())
+		ensureFilterKeys();
+	directory.m_rows.clear();
+	for (int i = 0; i < directory.m_entryCount; i++)
+	{
+		int entryIndex = directory.m_firstEntryIndex + i;
+		m_info->m_entryRows[entryIndex] = -1;
+		if (m_info->m_filterText.isEmpty()
+			|| m_info->m_entryTypes[entryIndex] == EntryType::Directory
+			|| m_info->m_entryFilterKeys[entryIndex].contains(m_info->m_filterText))
+		{
+			directory.m_rows.push_back(i);
+		}
+	}
+
+	// sort; ties stay in the order on the image
+	if (m_info->m_sortColumn >= 0)
+	{
+		MetaColumn &column = m_info->m_metaColumns[m_info->m_sortColumn];
+		int firstEntryIndex = directory.m_firstEntryIndex;
+		bool descending = m_info->m_sortOrder == Qt::DescendingOrder;
+		if (column.m_type == fs::meta_type::string)
+		{
+			ensureSortKeys(column);
+			std::ranges::stable_sort(directory.m_rows, [&column, firstEntryIndex, descending](int a, int b)
+			{
+				int result = column.m_sortKeys[firstEntryIndex + a].compare(column.m_sortKeys[firstEntryIndex + b]);
+				return descending ? result > 0 : result < 0;
+			});
+		}
+		else if (column.m_type == fs::meta_type::date)
+		{
+			// entries without this piece of metadata go first; dates compare field by field,
+			// so that the ones that are not real dates still have a place
+			auto key = [&column, firstEntryIndex](int i)
+			{
+				const util::arbitrary_datetime &date = column.m_dates[firstEntryIndex + i];
+				return std::make_tuple((bool)column.m_isPresent[firstEntryIndex + i], date.year, date.month, date.day_of_month, date.hour, date.minute, date.second);
+			};
+			std::ranges::stable_sort(directory.m_rows, [&key, descending](int a, int b)
+			{
+				return descending ? key(b) < key(a) : key(a) < key(b);
+			});
+		}
+		else
+		{
+			// entries without this piece of metadata go first
+			auto key = [&column, firstEntryIndex](int i)
+			{
+				return std::pair<bool, uint64_t>(column.m_isPresent[firstEntryIndex + i], column.m_numbers[firstEntryIndex + i]);
+			};
+			std::ranges::stable_sort(directory.m_rows, [&key, descending](int a, int b)
+			{
+				return descending ? key(b) < key(a) : key(a) < key(b);
+			});
+		}
+	}
+
+	for (int row = 0; row < (int)directory.m_rows.size(); row++)
+		m_info->m_entryRows[directory.m_firstEntryIndex + directory.m_rows[row]] = row;
+}
+
+
+//-------------------------------------------------
+//  ensureSortKeys
+//-------------------------------------------------
+
+void ImageItemModel::ensureSortKeys(MetaColumn &column) const
+{
+	// keys are built from the display text, so that we sort what the user sees
+	column.m_sortKeys.reserve(column.m_isPresent.size());
+	for (int entryIndex = (int)column.m_sortKeys.size(); entryIndex < (int)column.m_isPresent.size(); entryIndex++)
+		column.m_sortKeys.push_back(m_info->m_collator.sortKey(displayText(column, entryIndex)));
+}
+
+
+//-------------------------------------------------
+//  ensureFilterKeys
+//-------------------------------------------------
+
+void ImageItemModel::ensureFilterKeys() const
+{
+	m_info->m_entryFilterKeys.reserve(m_info->m_entryNames.size());
+	for (int entryIndex = (int)m_info->m_entryFilterKeys.size(); entryIndex < (int)m_info->m_entryNames.size(); entryIndex++)
+		m_info->m_entryFilterKeys.push_back(convert(entryName(entryIndex)).toCaseFolded());
+}
+
+
+//-------------------------------------------------
+//  detachImage
+//-------------------------------------------------
+
+Floptool::Image::ptr ImageItemModel::detachImage()
+{
+	assert(m_image);
+	stopPrefetch();
+	stopSearchIndex();
+	return std::move(m_image);
+}
+
+
+//-------------------------------------------------
+//  findEntry
+//-------------------------------------------------
+
+int ImageItemModel::findEntry(int directoryIndex, int directoryEntryIndex) const
+{
+	return m_info->m_directories[directoryIndex].m_firstEntryIndex + directoryEntryIndex;
+}
+
+
+//-------------------------------------------------
+//  findEntry
+//-------------------------------------------------
+
+int ImageItemModel::findEntry(const QModelIndex &index) const
+{
+	return index.isValid()
+		? findEntry(index.internalId(), directoryEntryIndex(index))
+		: -1;
+}
+
+
+//-------------------------------------------------
+//  directoryEntryIndex
+//-------------------------------------------------
+
+int ImageItemModel::directoryEntryIndex(const QModelIndex &index) const
+{
+	return m_info->m_directories[index.internalId()].m_rows[index.row()];
+}
+
+
+//-------------------------------------------------
+//  entryName
+//-------------------------------------------------
+
+std::string_view ImageItemModel::entryName(int entryIndex) const
+{
+	// the view is only good until the next directory gets loaded
+	return m_info->string(m_info->m_entryNames[entryIndex]);
+}
+
+
+//-------------------------------------------------
+//  convert
+//-------------------------------------------------
+
+QString ImageItemModel::convert(std::string_view s) const
+{
+	return m_image->convert(s);
+}
+
+
+//-------------------------------------------------
+//  metadataText
+//-------------------------------------------------
+
+QString ImageItemModel::metadataText(const MetaColumn &column, int entryIndex) const
+{
+	// everything but strings goes through meta_value::to_string(), so that cells read
+	// exactly the way MAME formats them
+	QString result;
+	if (column.m_isPresent[entryIndex])
+	{
+		switch (column.m_type)
+		{
+		case fs::meta_type::string:
+			result = convert(m_info->string(column.m_strings[entryIndex]));
+			break;
+		case fs::meta_type::number:
+			result = convert(fs::meta_value(column.m_numbers[entryIndex]).to_string());
+			break;
+		case fs::meta_type::flag:
+			result = convert(fs::meta_value(column.m_numbers[entryIndex] != 0).to_string());
+			break;
+		case fs::meta_type::date:
+			result = convert(fs::meta_value(column.m_dates[entryIndex]).to_string());
+			break;
+		}
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  displayText
+//-------------------------------------------------
+
+const QString &ImageItemModel::displayText(MetaColumn &column, int entryIndex) const
+{
+	// views ask for the same cells over and over (resizeColumnToContents() asks for all
+	// of them), and the image never changes underneath us, so each cell is formatted once
+	if (!column.m_isDisplayTextCached[entryIndex])
+	{
+		column.m_displayTexts[entryIndex] = metadataText(column, entryIndex);
+		column.m_isDisplayTextCached[entryIndex] = true;
+	}
+	return column.m_displayTexts[entryIndex];
+}
+
+
+//-------------------------------------------------
+//  iconFromEntry
+//-------------------------------------------------
+
+QPixmap ImageItemModel::iconFromEntry(int entryIndex) const
+{
+	QPixmap result;
+	switch (m_info->m_entryTypes[entryIndex])
+	{
+	case EntryType::File:
+		result = m_fileIcon;
+		break;
+	case EntryType::Directory:
+		result = m_info->m_entryIsExpanded[entryIndex] ? m_folderOpenIcon : m_folderIcon;
+		break;
+	default:
+		throw false;
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  fileName
+//-------------------------------------------------
+
+QString ImageItemModel::fileName(const QModelIndex &index) const
+{
+	int entryIndex = findEntry(index);
+	return entryIndex >= 0
+		? convert(entryName(entryIndex))
+		: "";
+}
+
+
+//-------------------------------------------------
+//  pathFromModelIndex
+//-------------------------------------------------
+
+std::vector<std::string> ImageItemModel::pathFromModelIndex(const QModelIndex &index, int &directoryIndex, int &directoryEntryIndex) const
+{
+	std::vector<std::string> result;
+
+	// look up the directory entry
+	if (index.isValid())
+	{
+		directoryIndex = index.internalId();
+		directoryEntryIndex = this->directoryEntryIndex(index);
+
+		// determine the path
+		result = expandPath(m_info->m_directories[directoryIndex].m_path);
+		result.emplace_back(entryName(findEntry(directoryIndex, directoryEntryIndex)));
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  readFile
+//-------------------------------------------------
+
+std::optional<std::vector<uint8_t>> ImageItemModel::readFile(const QModelIndex &index) const
+{
+	// determine the path
+	int directoryIndex, directoryEntryIndex;
+	std::vector<std::string> pathOnImage = pathFromModelIndex(index, directoryIndex, directoryEntryIndex);
+	return m_image->readFile(pathOnImage);
+}
+
+
+//-------------------------------------------------
+//  pathOnImage
+//-------------------------------------------------
+
+std::vector<std::string> ImageItemModel::pathOnImage(const QModelIndex &index) const
+{
+	int directoryIndex, directoryEntryIndex;
+	return pathFromModelIndex(index, directoryIndex, directoryEntryIndex);
+}
+
+
+//-------------------------------------------------
+//  index
+//-------------------------------------------------
+
+QModelIndex ImageItemModel::index(int row, int column, const QModelIndex &parent) const
+{
+	int parentEntryIndex = findEntry(parent);
+	return createIndex(row, column, parentEntryIndex >= 0 ? m_info->m_entryDirectoryIndexes[parentEntryIndex] : 0);
+}
+
+
+//-------------------------------------------------
+//  parent
+//-------------------------------------------------
+
+QModelIndex ImageItemModel::parent(const QModelIndex &child) const
+{
+	const Directory &directory = m_info->m_directories[child.internalId()];
+	return directory.m_parentIndex >= 0 && directory.m_parentEntryIndex >= 0
+		? createIndex(m_info->m_entryRows[findEntry(directory.m_parentIndex, directory.m_parentEntryIndex)], 0, directory.m_parentIndex)
+		: QModelIndex();
+}
+
+
+//-------------------------------------------------
+//  rowCount
+//-------------------------------------------------
+
+int ImageItemModel::rowCount(const QModelIndex &parent) const
+{
+	int parentEntryIndex = findEntry(parent);
+	int parentDirectoryIndex = parentEntryIndex >= 0 ? m_info->m_entryDirectoryIndexes[parentEntryIndex] : 0;
+	return parentDirectoryIndex >= 0
+		? (int)m_info->m_directories[parentDirectoryIndex].m_rows.size()
+		: 0;
+}
+
+
+//-------------------------------------------------
+//  columnCount
+//-------------------------------------------------
+
+int ImageItemModel::columnCount(const QModelIndex &parent) const
+{
+	return m_info->m_metaNames.size();
+}
+
+
+//-------------------------------------------------
+//  hasChildren
+//-------------------------------------------------
+
+bool ImageItemModel::hasChildren(const QModelIndex &parent) const
+{
+	return rowCount(parent) > 0;
+}
+
+
+//-------------------------------------------------
+//  flags
+//-------------------------------------------------
+
+Qt::ItemFlags ImageItemModel::flags(const QModelIndex &index) const
+{
+	return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+
+//-------------------------------------------------
+//  headerData
+//-------------------------------------------------
+
+QVariant ImageItemModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	QVariant result;
+	if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
+	{
+		switch (role)
+		{
+		case Qt::DisplayRole:
+			{
+				fs::meta_name name = m_info->m_metaNames[section];
+				const char *name_str = fs::meta_data::entry_name(name);
+				result = convert(name_str);
+			}
+			break;
+
+		case Qt::FontRole:
+			{
+				QFont font;
+				font.setUnderline(true);
+				result = std::move(font);
+			}
+			break;
+		}
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  data
+//-------------------------------------------------
+
+QVariant ImageItemModel::data(const QModelIndex &index, int role) const
+{
+	QVariant result;
+	int entryIndex = findEntry(index);
+	if (entryIndex >= 0)
+	{
+		MetaColumn &column = m_info->m_metaColumns[index.column()];
+		switch (role)
+		{
+		case Qt::DisplayRole:
+			result = displayText(column, entryIndex);
+			break;
+
+		case Qt::TextAlignmentRole:
+			result = column.m_textAlignment;
+			break;
+
+		case Qt::DecorationRole:
+			if (index.column() == 0)
+				result = iconFromEntry(entryIndex);
+			break;
+		}
+	}
+	return result;
+}
@@ -1,89 +1,120 @@
-/***************************************************************************
-
-	imageitemmodel.h
-
-	QAbstractItemModel implementation for an image
-
-***************************************************************************/
-
-#ifndef IMAGEITEMMODEL_H
-#define IMAGEITEMMODEL_H
-
-// qfloptool headers
-#include "floptool.h"
-
-// Qt headers
-#include <QAbstractItemModel>
-#include <QPixmap>
-
-
-QT_BEGIN_NAMESPACE
-class QDir;
-QT_END_NAMESPACE
-
-
-//**************************************************************************
-//  TYPE DECLARATIONS
-//**************************************************************************
-
-// ======================> ImageItemModel
-
-class ImageItemModel : public QAbstractItemModel
-{
-public:
-	// ctor/dtor
-	ImageItemModel(Floptool::Image::ptr &&image, QObject *parent = nullptr);
-	~ImageItemModel();
-
-	// accessors
-	Floptool::Image::ptr &image() { return m_image; }
-
-	// methods
-	void loadItem(const QModelIndex &index);
-	void setExpanded(const QModelIndex &index, bool expanded);
-	Floptool::Image::ptr detachImage();
-	QString fileName(const QModelIndex &index) const;
-	std::optional<std::vector<uint8_t>> readFile(const QModelIndex &index) const;
-	void extract(const QModelIndex &index, const QString &path, bool appendImageFileName);
-
-	// virtuals
-	virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override final;
-	virtual QModelIndex parent(const QModelIndex &child) const override final;
-	virtual int rowCount(const QModelIndex &parent) const override final;
-	virtual int columnCount(const QModelIndex &parent = QModelIndex()) const override final;
-	virtual bool hasChildren(const QModelIndex &parent) const final;
-	virtual Qt::ItemFlags flags(const QModelIndex &index) const override final;
-	virtual QVariant headerData(int section, Qt::Orientation orientation, int role) const override final;
-	virtual QVariant data(const QModelIndex &index, int role) const override final;
-
-private:
-	enum class EntryType
-	{
-		Directory,
-		File
-	};
-
-	struct DirectoryEntry;
-	struct Directory;
-	struct Info;
-
-	// members
-	Floptool::Image::ptr			m_image;
-	std::unique_ptr<Info>			m_info;
-	QPixmap							m_fileIcon;
-	QPixmap							m_folderIcon;
-	QPixmap							m_folderOpenIcon;
-
-	// private methods
-	int loadDirectory(int parentIndex, int parentEntryIndex);
-	void appendDirectoryPath(std::vector<std::string> &path, int directoryIndex) const;
-	const DirectoryEntry *findDirectoryEntry(const QModelIndex &index) const; 
-	DirectoryEntry *findDirectoryEntry(const QModelIndex &index);
-	QString convert(std::string_view s) const;
-	QPixmap iconFromDirectoryEntry(const DirectoryEntry &directoryEntry) const;
-	std::vector<std::string> pathFromModelIndex(const QModelIndex &index, int &directoryIndex, int &directoryEntryIndex) const;
-	void internalExtract(std::vector<std::string> &pathOnImage, int directoryIndex, int directoryEntryIndex, const QString &path);
-};
-
-
-#endif // IMAGEITEMMODEL_H
+/***************************************************************************
+
+	imageitemmodel.h
+
+	QAbstractItemModel implementation for an image
+
+***************************************************************************/
+
+#ifndef IMAGEITEMMODEL_H
+#define IMAGEITEMMODEL_H
+
+// qfloptool headers
+#include "floptool.h"
+#include "searchindex.h"
+
+// Qt headers
+#include <QAbstractItemModel>
+#include <QFuture>
+#include <QPixmap>
+
+
+QT_BEGIN_NAMESPACE
+class QDir;
+QT_END_NAMESPACE
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> ImageItemModel
+
+class ImageItemModel : public QAbstractItemModel
+{
+public:
+	// ctor/dtor
+	ImageItemModel(Floptool::Image::ptr &&image, QObject *parent = nullptr);
+	~ImageItemModel();
+
+	// accessors
+	Floptool::Image::ptr &image() { return m_image; }
+
+	// methods
+	void loadItem(const QModelIndex &index);
+	void setExpanded(const QModelIndex &index, bool expanded);
+	Floptool::Image::ptr detachImage();
+	QString fileName(const QModelIndex &index) const;
+	std::optional<std::vector<uint8_t>> readFile(const QModelIndex &index) const;
+	std::vector<std::string> pathOnImage(const QModelIndex &index) const;
+	void prefetch(const QModelIndexList &visibleIndexes);
+	void setFilterText(const QString &text);
+	QFuture<SearchIndex::ptr> searchIndex();
+	QModelIndex indexFromPath(const std::vector<std::string> &path);
+
+	// virtuals
+	virtual QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override final;
+	virtual QModelIndex parent(const QModelIndex &child) const override final;
+	virtual int rowCount(const QModelIndex &parent) const override final;
+	virtual int columnCount(const QModelIndex &parent = QModelIndex()) const override final;
+	virtual bool hasChildren(const QModelIndex &parent) const final;
+	virtual Qt::ItemFlags flags(const QModelIndex &index) const override final;
+	virtual QVariant headerData(int section, Qt::Orientation orientation, int role) const override final;
+	virtual QVariant data(const QModelIndex &index, int role) const override final;
+	virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override final;
+
+private:
+	enum class EntryType : uint8_t
+	{
+		Directory,
+		File
+	};
+
+	// a path on the image, as a chain of names up to the root (which is null); each
+	// directory holds one link and shares it with everything below it
+	struct PathNode;
+	typedef std::shared_ptr<const PathNode> PathHandle;
+
+	struct StringRef;
+	struct MetaColumn;
+	struct Directory;
+	struct Info;
+	struct Prefetcher;
+
+	// members
+	Floptool::Image::ptr			m_image;
+	std::unique_ptr<Info>			m_info;
+	std::unique_ptr<Prefetcher>		m_prefetcher;
+	std::optional<QFuture<SearchIndex::ptr>>	m_searchIndexFuture;
+	QPixmap							m_fileIcon;
+	QPixmap							m_folderIcon;
+	QPixmap							m_folderOpenIcon;
+
+	// private methods
+	int loadDirectory(int parentIndex, int parentEntryIndex);
+	int addDirectory(int parentIndex, int parentEntryIndex, PathHandle &&path, std::vector<fs::dir_entry> &&entries);
+	void enqueuePrefetch(int directoryIndex, int directoryEntryIndex, bool prioritize);
+	void enqueueSubdirectoryPrefetches(int directoryIndex);
+	void prefetchWorker();
+	void publishPrefetchResults();
+	void stopPrefetch();
+	void stopSearchIndex();
+	void rearrangeAllRows();
+	void arrangeRows(int directoryIndex);
+	void ensureSortKeys(MetaColumn &column) const;
+	void ensureFilterKeys() const;
+	PathHandle entryPath(int directoryIndex, int directoryEntryIndex) const;
+	static std::vector<std::string> expandPath(const PathHandle &path);
+	int findEntry(int directoryIndex, int directoryEntryIndex) const;
+	int findEntry(const QModelIndex &index) const;
+	int directoryEntryIndex(const QModelIndex &index) const;
+	std::string_view entryName(int entryIndex) const;
+	QString convert(std::string_view s) const;
+	QString metadataText(const MetaColumn &column, int entryIndex) const;
+	const QString &displayText(MetaColumn &column, int entryIndex) const;
+	QPixmap iconFromEntry(int entryIndex) const;
+	std::vector<std::string> pathFromModelIndex(const QModelIndex &index, int &directoryIndex, int &directoryEntryIndex) const;
+};
+
+
+#endif // IMAGEITEMMODEL_H
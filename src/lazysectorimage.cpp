@@ -0,0 +1,392 @@
+/***************************************************************************
+
+	lazysectorimage.cpp
+
+	Block device that decodes sectors from a floppy_image on demand
+
+***************************************************************************/
+
+// qfloptool headers
+#include "lazysectorimage.h"
+
+// Qt headers
+#include <QtConcurrent>
+
+// MAME headers
+#include "formats/flopimg.h"
+#include "formats/upd765_dsk.h"
+#include "formats/wd177x_dsk.h"
+
+// C++ headers
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+
+//**************************************************************************
+//  TYPE DEFINITIONS
+//**************************************************************************
+
+namespace
+{
+	// ======================> MameTrackDecoder
+
+	// never instantiated; this only exists to reach the bitstream helpers that MAME
+	// keeps protected within floppy_image_format_t
+	class MameTrackDecoder : public floppy_image_format_t
+	{
+	public:
+		using floppy_image_format_t::generate_bitstream_from_track;
+		using floppy_image_format_t::extract_sectors_from_bitstream_fm_pc;
+		using floppy_image_format_t::extract_sectors_from_bitstream_mfm_pc;
+	};
+
+
+	// ======================> MameWd177xInspector
+
+	// never instantiated either; this reaches the format table and the per-track hooks
+	// that wd177x_format keeps protected, so we can ask a converter how it lays out its
+	// image rather than guessing
+	class MameWd177xInspector : public wd177x_format
+	{
+	public:
+		static const format *formatTable(const wd177x_format &converter)
+		{
+			return converter.*(&MameWd177xInspector::formats);
+		}
+
+		static const format &trackFormat(const wd177x_format &converter, const format &f, int head, int track)
+		{
+			return (converter.*(&MameWd177xInspector::get_track_format))(f, head, track);
+		}
+
+		static int imageOffset(const wd177x_format &converter, const format &f, int head, int track)
+		{
+			return (converter.*(&MameWd177xInspector::get_image_offset))(f, head, track);
+		}
+	};
+
+
+	// ======================> MameUpd765Inspector
+
+	class MameUpd765Inspector : public upd765_format
+	{
+	public:
+		static const format *formatTable(const upd765_format &converter)
+		{
+			return converter.*(&MameUpd765Inspector::formats);
+		}
+	};
+};
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+// cell sizes (in ns) used by the PC-style formats; DD, HD, 5.25" HD, ED and FM SD
+static const int s_probeCellSizes[] = { 2000, 1000, 1200, 500, 4000 };
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  extractSectors
+//-------------------------------------------------
+
+static std::vector<std::vector<uint8_t>> extractSectors(const floppy_image &image, int track, int head, int cellSize, bool isFm)
+{
+	std::vector<bool> bitstream = MameTrackDecoder::generate_bitstream_from_track(track, head, cellSize, &image);
+	return isFm
+		? MameTrackDecoder::extract_sectors_from_bitstream_fm_pc(bitstream)
+		: MameTrackDecoder::extract_sectors_from_bitstream_mfm_pc(bitstream);
+}
+
+
+//-------------------------------------------------
+//  findFormat - finds the entry in a converter's
+//	format table that describes the given layout
+//	exactly, with sectors in ID order
+//-------------------------------------------------
+
+template<typename TFormat>
+static const TFormat *findFormat(const TFormat *formats, const floppy_image &image, const LazySectorImage::TrackLayout &layout, int trackCount)
+{
+	uint32_t formFactor = image.get_form_factor();
+	uint32_t encoding = layout.m_isFm ? floppy_image::FM : floppy_image::MFM;
+	for (const TFormat *f = formats; f && f->form_factor; f++)
+	{
+		// a sector_base_size or sector_base_id of zero or below means per-sector tables,
+		// which we do not reproduce
+		if ((formFactor == floppy_image::FF_UNKNOWN || f->form_factor == formFactor)
+			&& f->encoding == encoding
+			&& f->cell_size == layout.m_cellSize
+			&& f->head_count == layout.m_headCount
+			&& f->track_count == trackCount
+			&& f->sector_count == layout.m_sectorCount
+			&& f->sector_base_size == layout.m_sectorSize
+			&& f->sector_base_id == layout.m_firstSectorId
+			&& f->sector_base_size > 0
+			&& f->sector_base_id >= 0)
+		{
+			return f;
+		}
+	}
+	return nullptr;
+}
+
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+LazySectorImage::LazySectorImage(std::shared_ptr<const void> &&owner, const floppy_image &image, const Geometry &geometry)
+	: m_owner(std::move(owner))
+	, m_image(image)
+	, m_geometry(geometry)
+	, m_trackIndexCount((std::size_t)geometry.m_trackCount * geometry.m_layout.m_headCount)
+	, m_data(geometry.imageSize())
+	, m_trackDecoded(std::make_unique<std::once_flag[]>(m_trackIndexCount))
+{
+}
+
+
+//-------------------------------------------------
+//  decodeAll
+//-------------------------------------------------
+
+void LazySectorImage::decodeAll()
+{
+	// tracks are independent of each other, so we can extract them all in parallel; the
+	// result is identical to having touched them one at a time
+	std::vector<std::size_t> trackIndexes(m_trackIndexCount);
+	std::iota(trackIndexes.begin(), trackIndexes.end(), 0);
+	QtConcurrent::blockingMap(trackIndexes, [this](std::size_t trackIndex)
+	{
+		ensureTrackDecoded(trackIndex);
+	});
+}
+
+
+//-------------------------------------------------
+//  probeTrackLayout
+//-------------------------------------------------
+
+std::optional<LazySectorImage::TrackLayout> LazySectorImage::probeTrackLayout(floppy_image &image)
+{
+	// decode track 0 and figure out its sector layout
+	int trackCount, headCount;
+	image.get_actual_geometry(trackCount, headCount);
+	if (trackCount <= 0 || headCount <= 0)
+		return {};
+
+	std::optional<TrackLayout> result;
+	for (int cellSize : s_probeCellSizes)
+	{
+		for (bool isFm : { false, true })
+		{
+			std::vector<std::vector<uint8_t>> sectors = extractSectors(image, 0, 0, cellSize, isFm);
+
+			// we only handle tracks with contiguous sector IDs of a uniform size
+			int firstSectorId = -1, sectorCount = 0, sectorSize = 0;
+			bool isRegular = true;
+			for (int id = 0; isRegular && id < (int)sectors.size(); id++)
+			{
+				if (sectors[id].empty())
+					continue;
+				if (firstSectorId < 0)
+				{
+					firstSectorId = id;
+					sectorSize = (int)sectors[id].size();
+				}
+				isRegular = id == firstSectorId + sectorCount && (int)sectors[id].size() == sectorSize;
+				sectorCount++;
+			}
+
+			if (isRegular && sectorCount > 0 && sectorSize >= 128 && (!result || sectorCount > result->m_sectorCount))
+				result = TrackLayout{ cellSize, isFm, headCount, sectorCount, sectorSize, firstSectorId };
+		}
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  predictGeometry
+//-------------------------------------------------
+
+std::optional<LazySectorImage::Geometry> LazySectorImage::predictGeometry(floppy_image &image, const TrackLayout &layout, const floppy_image_format_t &converter, uint32_t imageSize)
+{
+	// would this converter produce an image of the requested size?  only the PC-style
+	// converters lay out their images as a simple sequence of (track, head) blocks with
+	// sectors in ID order, and even then only when the layout we probed on track 0 is in
+	// the converter's own format table and holds for the whole disk
+	std::size_t cylinderSize = layout.trackSize() * layout.m_headCount;
+	if (cylinderSize == 0 || imageSize % cylinderSize != 0)
+		return {};
+
+	// the converter writes the tracks the disk actually has, no more and no fewer
+	int actualTrackCount, actualHeadCount;
+	image.get_actual_geometry(actualTrackCount, actualHeadCount);
+	int trackCount = (int)(imageSize / cylinderSize);
+	if (trackCount != actualTrackCount || trackCount > image.get_track_count())
+		return {};
+
+	if (const wd177x_format *wd177xConverter = dynamic_cast<const wd177x_format *>(&converter))
+	{
+		const wd177x_format::format *f = findFormat(MameWd177xInspector::formatTable(*wd177xConverter), image, layout, trackCount);
+		if (!f)
+			return {};
+
+		// some converters (FLEX and OS-9 among them) use a different layout on track 0, or
+		// place tracks somewhere other than in sequence; ask the converter itself
+		std::size_t trackSize = layout.trackSize();
+		for (int track = 0; track < trackCount; track++)
+		{
+			for (int head = 0; head < layout.m_headCount; head++)
+			{
+				std::size_t expectedOffset = ((std::size_t)track * layout.m_headCount + head) * trackSize;
+				if (&MameWd177xInspector::trackFormat(*wd177xConverter, *f, head, track) != f
+					|| (std::size_t)MameWd177xInspector::imageOffset(*wd177xConverter, *f, head, track) != expectedOffset)
+				{
+					return {};
+				}
+			}
+		}
+	}
+	else if (const upd765_format *upd765Converter = dynamic_cast<const upd765_format *>(&converter))
+	{
+		// upd765_format has no per-track hooks; every track follows the table entry
+		if (!findFormat(MameUpd765Inspector::formatTable(*upd765Converter), image, layout, trackCount))
+			return {};
+	}
+	else
+	{
+		return {};
+	}
+
+	return Geometry{ layout, trackCount };
+}
+
+
+//-------------------------------------------------
+//  block_count
+//-------------------------------------------------
+
+uint32_t LazySectorImage::block_count() const
+{
+	return m_data.size() / m_block_size;
+}
+
+
+//-------------------------------------------------
+//  get
+//-------------------------------------------------
+
+fs::fsblk_t::block_t LazySectorImage::get(uint32_t id)
+{
+	if (id >= block_count())
+		throw std::out_of_range("Block number overflow");
+
+	std::size_t offset = (std::size_t)m_block_size * id;
+	ensureDecoded(offset, m_block_size);
+	return block_t(new Block(m_data.data() + offset, m_block_size));
+}
+
+
+//-------------------------------------------------
+//  fill
+//-------------------------------------------------
+
+void LazySectorImage::fill(uint8_t data)
+{
+	// mark every track as decoded first, so that nothing gets decoded over the fill
+	for (std::size_t trackIndex = 0; trackIndex < m_trackIndexCount; trackIndex++)
+		std::call_once(m_trackDecoded[trackIndex], [] { });
+	std::fill(m_data.begin(), m_data.end(), data);
+}
+
+
+//-------------------------------------------------
+//  ensureDecoded
+//-------------------------------------------------
+
+void LazySectorImage::ensureDecoded(std::size_t offset, std::size_t length)
+{
+	std::size_t trackSize = m_geometry.m_layout.trackSize();
+	std::size_t lastTrackIndex = std::min((offset + length - 1) / trackSize, m_trackIndexCount - 1);
+	for (std::size_t trackIndex = offset / trackSize; trackIndex <= lastTrackIndex; trackIndex++)
+		ensureTrackDecoded(trackIndex);
+}
+
+
+//-------------------------------------------------
+//  ensureTrackDecoded
+//-------------------------------------------------
+
+void LazySectorImage::ensureTrackDecoded(std::size_t trackIndex)
+{
+	// each track is decoded exactly once; anybody else who needs it in the meantime waits
+	std::call_once(m_trackDecoded[trackIndex], [this, trackIndex]
+	{
+		int track = (int)(trackIndex / m_geometry.m_layout.m_headCount);
+		int head = (int)(trackIndex % m_geometry.m_layout.m_headCount);
+		decodeTrack(track, head, m_data.data() + trackIndex * m_geometry.m_layout.trackSize());
+	});
+}
+
+
+//-------------------------------------------------
+//  decodeTrack
+//-------------------------------------------------
+
+void LazySectorImage::decodeTrack(int track, int head, uint8_t *dest) const
+{
+	const TrackLayout &layout = m_geometry.m_layout;
+	std::vector<std::vector<uint8_t>> sectors = extractSectors(m_image, track, head, layout.m_cellSize, layout.m_isFm);
+
+	for (int i = 0; i < layout.m_sectorCount; i++)
+	{
+		// unreadable sectors come out the same way the stream based conversion would have left them
+		std::size_t id = layout.m_firstSectorId + i;
+		uint8_t *sectorDest = dest + (std::size_t)i * layout.m_sectorSize;
+		if (id < sectors.size() && sectors[id].size() >= (std::size_t)layout.m_sectorSize)
+			memcpy(sectorDest, sectors[id].data(), layout.m_sectorSize);
+		else
+			memset(sectorDest, 0xFF, layout.m_sectorSize);
+	}
+}
+
+
+//-------------------------------------------------
+//  Block ctor
+//-------------------------------------------------
+
+LazySectorImage::Block::Block(uint8_t *data, uint32_t size)
+	: iblock_t(size)
+	, m_data(data)
+{
+}
+
+
+//-------------------------------------------------
+//  Block::rodata
+//-------------------------------------------------
+
+const uint8_t *LazySectorImage::Block::rodata()
+{
+	return m_data;
+}
+
+
+//-------------------------------------------------
+//  Block::data
+//-------------------------------------------------
+
+uint8_t *LazySectorImage::Block::data()
+{
+	return m_data;
+}
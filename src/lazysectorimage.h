@@ -0,0 +1,98 @@
+/***************************************************************************
+
+	lazysectorimage.h
+
+	Block device that decodes sectors from a floppy_image on demand
+
+***************************************************************************/
+
+#ifndef LAZYSECTORIMAGE_H
+#define LAZYSECTORIMAGE_H
+
+// MAME headers
+#include "formats/fsblk.h"
+
+// C++ headers
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+
+class floppy_image;
+class floppy_image_format_t;
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> LazySectorImage
+
+class LazySectorImage : public fs::fsblk_t
+{
+public:
+	// the sector layout of a PC-style (FM or MFM) track, as found on track 0
+	struct TrackLayout
+	{
+		int		m_cellSize;
+		bool	m_isFm;
+		int		m_headCount;
+		int		m_sectorCount;
+		int		m_sectorSize;
+		int		m_firstSectorId;
+
+		std::size_t trackSize() const { return (std::size_t)m_sectorCount * m_sectorSize; }
+	};
+
+	// the full geometry of the sector image we present
+	struct Geometry
+	{
+		TrackLayout	m_layout;
+		int			m_trackCount;
+
+		std::size_t imageSize() const { return m_layout.trackSize() * m_layout.m_headCount * m_trackCount; }
+	};
+
+	// ctor
+	LazySectorImage(std::shared_ptr<const void> &&owner, const floppy_image &image, const Geometry &geometry);
+
+	// methods
+	void decodeAll();
+
+	// statics
+	static std::optional<TrackLayout> probeTrackLayout(floppy_image &image);
+	static std::optional<Geometry> predictGeometry(floppy_image &image, const TrackLayout &layout, const floppy_image_format_t &converter, uint32_t imageSize);
+
+	// virtuals
+	virtual uint32_t block_count() const override;
+	virtual block_t get(uint32_t id) override;
+	virtual void fill(uint8_t data) override;
+
+private:
+	class Block : public iblock_t
+	{
+	public:
+		Block(uint8_t *data, uint32_t size);
+
+		virtual const uint8_t *rodata() override;
+		virtual uint8_t *data() override;
+
+	private:
+		uint8_t *	m_data;
+	};
+
+	std::shared_ptr<const void>		m_owner;
+	const floppy_image &			m_image;
+	Geometry						m_geometry;
+	std::size_t						m_trackIndexCount;
+	std::vector<uint8_t>			m_data;
+	std::unique_ptr<std::once_flag[]>	m_trackDecoded;
+
+	void ensureDecoded(std::size_t offset, std::size_t length);
+	void ensureTrackDecoded(std::size_t trackIndex);
+	void decodeTrack(int track, int head, uint8_t *dest) const;
+};
+
+
+#endif // LAZYSECTORIMAGE_H
@@ -1,524 +1,785 @@
-/***************************************************************************
-
-	mainwindow.cpp
-
-	Main qfloptool window
-
-***************************************************************************/
-
-// qfloptool includes
-#include "mainwindow.h"
-#include "./ui_mainwindow.h"
-#include "floptool.h"
-#include "imageitemmodel.h"
-#include "dialogs/identify.h"
-#include "dialogs/viewfile.h"
-
-// Qt includes
-#include <QFileDialog>
-#include <QFontDatabase>
-#include <QMessageBox>
-#include <QMenu>
-#include <QSettings>
-
-
-//**************************************************************************
-//  IMPLEMENTATION
-//**************************************************************************
-
-//-------------------------------------------------
-//  ctor
-//-------------------------------------------------
-
-MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent)
-{
-	m_ui = std::make_unique<Ui::MainWindow>();
-    m_ui->setupUi(this);
-
-	// cosmetic (why can't this be done in mainwindow.ui?)
-	QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
-	m_ui->mainTree->setFont(font);
-
-	// set up recent actions
-	for (auto i = 0; i < std::size(m_recentActions); i++)
-	{	
-		m_recentActions[i] = new QAction(this);
-		m_ui->menuFile->insertAction(m_ui->actionClose, m_recentActions[i]);
-		connect(m_recentActions[i], &QAction::triggered, this, [this, i]()
-		{
-			loadRecent(i);
-		});
-	}
-
-	// set up the separator after recent actions
-	QAction &separator = *m_ui->menuFile->insertSeparator(m_ui->actionClose);
-	connect(&separator, &QAction::visibleChanged, this, [this, &separator]()
-	{
-		separator.setVisible(m_recentActions[0]->isVisible());
-	});
-
-	// handle folder expansion events
-	connect(m_ui->mainTree, &QTreeView::doubleClicked, this, [this](const QModelIndex &index)
-	{
-		ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
-		if (model)
-			model->loadItem(index);
-	});
-	connect(m_ui->mainTree, &QTreeView::expanded, this, [this](const QModelIndex &index)
-	{
-		ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
-		if (model)
-			model->setExpanded(index, true);
-	});
-	connect(m_ui->mainTree, &QTreeView::collapsed, this, [this](const QModelIndex &index)
-	{
-		ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
-		if (model)
-			model->setExpanded(index, false);
-	});
-
-	// update the title
-	setTitleFromImageInfo();
-}
-
-
-//-------------------------------------------------
-//  dtor
-//-------------------------------------------------
-
-MainWindow::~MainWindow()
-{
-}
-
-
-//-------------------------------------------------
-//  startNewWindow
-//-------------------------------------------------
-
-MainWindow &MainWindow::startNewWindow()
-{
-	MainWindow &newWindow = *new MainWindow();
-	newWindow.setAttribute(Qt::WA_DeleteOnClose);
-	newWindow.show();
-	return newWindow;
-}
-
-
-//-------------------------------------------------
-//  buildNameFilters
-//-------------------------------------------------
-
-QStringList MainWindow::buildNameFilters()
-{
-	QStringList results;
-	results << "All files(*)";
-
-	for (const auto &floppyFormatCategory : Floptool::instance().floppyFormats())
-	{
-		for (const Floptool::FloppyFormat &floppyFormat : floppyFormatCategory)
-		{
-			QString extensions;
-			for (const QString &ext : floppyFormat.fileExtensions())
-			{
-				if (!extensions.isEmpty())
-					extensions.append(" ");
-				extensions.append("*.");
-				extensions.append(ext);
-			}
-			results << QString("%1: %2 (%3)").arg(floppyFormatCategory.categoryName(), floppyFormat.description(), extensions);
-		}
-	}
-	return results;
-}
-
-
-//-------------------------------------------------
-//  updateRecents
-//-------------------------------------------------
-
-void MainWindow::updateRecents()
-{
-	QSettings settings;
-
-	bool atEnd = false;
-	for (int i = 0; i < std::size(m_recentActions); i++)
-	{
-		if (!atEnd)
-		{
-			QString settingName = recentFileSettingName(i);
-			QString settingValue = settings.value(settingName).toString();
-			QString thisFileName, thisFloppyFormatName, thisFileSystemName;
-			atEnd = !parseRecentFileSettingValue(settingValue, thisFileName, thisFloppyFormatName, thisFileSystemName);
-			if (!atEnd)
-				m_recentActions[i]->setText(QFileInfo(thisFileName).fileName());
-		}
-		m_recentActions[i]->setVisible(!atEnd);
-	}
-}
-
-
-//-------------------------------------------------
-//  loadRecent
-//-------------------------------------------------
-
-bool MainWindow::loadRecent(int i)
-{
-	// find the recent file out of settings
-	QSettings settings;
-	QString settingName = recentFileSettingName(i);
-	QString settingValue = settings.value(settingName).toString();
-	QString fileName, floppyFormatName, fileSystemName;
-	if (!parseRecentFileSettingValue(settingValue, fileName, floppyFormatName, fileSystemName))
-		return false;
-
-	// find the actual format and file system
-	const Floptool::FloppyFormat *floppyFormat = Floptool::instance().findFloppyFormat(floppyFormatName);
-	if (!floppyFormat)
-		return false;
-	const Floptool::FileSystem *fileSystem = Floptool::instance().findFileSystem(fileSystemName);
-	if (!fileSystem)
-		return false;
-
-	// open the file
-	QFile file(fileName);
-	if (!file.open(QIODevice::ReadOnly))
-		return false;
-
-	// mount the image
-	Floptool::Image::ptr image = Floptool::instance().mount(file, *floppyFormat, *fileSystem);
-	if (!image)
-		return false;
-
-	// and load it!
-	return loadImage(std::move(image), std::move(fileName), std::move(floppyFormatName), std::move(fileSystemName));
-}
-
-
-//-------------------------------------------------
-//  loadImage
-//-------------------------------------------------
-
-bool MainWindow::loadImage(Floptool::Image::ptr &&image, QString &&fileName, QString &&floppyFormatName, QString &&fileSystemName)
-{
-	// set the model
-	ImageItemModel &previewModel = *new ImageItemModel(std::move(image), this);
-	m_ui->mainTree->setModel(&previewModel);
-
-	// for some reason, the signal needs to be set up here
-	connect(m_ui->mainTree->selectionModel(), &QItemSelectionModel::selectionChanged, this, [this](const QItemSelection &selected, const QItemSelection &deselected)
-	{
-		m_ui->actionView->setEnabled(!selected.indexes().isEmpty());
-		m_ui->actionExtract->setEnabled(!selected.indexes().isEmpty());
-	});
-
-	// update the title
-	setTitleFromImageInfo(fileName);
-
-	// resize all columns
-	int columnCount = previewModel.columnCount();
-	for (int column = 0; column < columnCount; column++)
-		m_ui->mainTree->resizeColumnToContents(column);
-
-	// and add this to recent files
-	addRecent(fileName, std::move(floppyFormatName), std::move(fileSystemName));
-	return true;
-}
-
-
-//-------------------------------------------------
-//  addRecent
-//-------------------------------------------------
-
-void MainWindow::addRecent(const QString &fileName, QString &&floppyFormatName, QString &&fileSystemName)
-{
-	QSettings settings;
-	QString lastFileName = fileName;
-	for (int i = 0; i < std::size(m_recentActions); i++)
-	{
-		// identify the setting name and get the current value
-		QString settingName = recentFileSettingName(i);
-		QString settingValue = settings.value(settingName).toString();
-		QString thisFileName, thisFloppyFormatName, thisFileSystemName;
-		parseRecentFileSettingValue(settingValue, thisFileName, thisFloppyFormatName, thisFileSystemName);
-
-		// set the new value
-		QString newSettingValue = QString("%1,%2,%3").arg(floppyFormatName, fileSystemName, lastFileName);
-		settings.setValue(settingName, newSettingValue);
-
-		// if its time to bail, do so
-		if (thisFileName == fileName)
-			break;
-
-		// advance
-		lastFileName = std::move(thisFileName);
-		floppyFormatName = std::move(thisFloppyFormatName);
-		fileSystemName = std::move(thisFileSystemName);
-	}
-}
-
-
-//-------------------------------------------------
-//  parseRecentFileSettingValue
-//-------------------------------------------------
-
-bool MainWindow::parseRecentFileSettingValue(const QString &settingValue, QString &fileName, QString &floppyFormatName, QString &fileSystemName)
-{
-	qsizetype firstCommaPos = settingValue.indexOf(',', 0);
-	if (firstCommaPos < 0)
-		return false;
-	qsizetype secondCommaPos = settingValue.indexOf(',', firstCommaPos + 1);
-	if (secondCommaPos < 0 || secondCommaPos >= settingValue.size() - 1)
-		return false;
-
-	floppyFormatName = settingValue.left(firstCommaPos);
-	fileSystemName = settingValue.mid(firstCommaPos + 1, secondCommaPos - firstCommaPos - 1);
-	fileName = settingValue.right(settingValue.size() - secondCommaPos - 1);
-	return true;
-}
-
-
-//-------------------------------------------------
-//  recentFileSettingName
-//-------------------------------------------------
-
-QString MainWindow::recentFileSettingName(int i)
-{
-	return QString("recentfiles/%1").arg(i);
-}
-
-
-//-------------------------------------------------
-//  setTitleFromImageInfo
-//-------------------------------------------------
-
-void MainWindow::setTitleFromImageInfo(const QString &fileName)
-{
-	QString title = QCoreApplication::applicationName();
-	if (!fileName.isEmpty())
-		title += QString(" - %1").arg(QFileInfo(fileName).fileName());
-
-	ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
-	if (model && model->image())
-	{
-		std::optional<QString> volumeName = model->image()->volumeName();
-		if (volumeName)
-			title += QString(" (\"%1\")").arg(*volumeName);
-	}
-	setWindowTitle(title);
-}
-
-
-//-------------------------------------------------
-//  extractSingle
-//-------------------------------------------------
-
-void MainWindow::extractSingle(ImageItemModel &model, const QModelIndex &index)
-{
-	QString defaultFileName = model.fileName(index);
-	if (defaultFileName.isEmpty())
-		return;
-
-	QFileDialog fileDialog;
-	fileDialog.setWindowTitle("Extract");
-	fileDialog.setAcceptMode(QFileDialog::AcceptSave);
-	fileDialog.setFileMode(QFileDialog::AnyFile);
-	fileDialog.selectFile(defaultFileName);
-	if (fileDialog.exec() != QDialog::Accepted)
-		return;
-
-	QString saveFileName = fileDialog.selectedFiles()[0];
-	model.extract(index, saveFileName, false);
-}
-
-
-//-------------------------------------------------
-//  extractMultiple
-//-------------------------------------------------
-
-void MainWindow::extractMultiple(ImageItemModel &model, const QModelIndexList &indexes)
-{
-	QString path = QFileDialog::getExistingDirectory(this, "Extract");
-	if (path.isEmpty())
-		return;
-
-	for (const QModelIndex &index : indexes)
-		model.extract(index, path, true);
-}
-
-
-//-------------------------------------------------
-//  addReplicatedAction
-//-------------------------------------------------
-
-QAction &MainWindow::addReplicatedAction(QMenu &menu, QAction &existingAction)
-{
-	QAction &newAction = *menu.addAction(existingAction.text(), [&existingAction] { existingAction.triggered(); });
-	newAction.setEnabled(existingAction.isEnabled());
-	return newAction;
-}
-
-
-//-------------------------------------------------
-//  on_menuFile_aboutToShow
-//-------------------------------------------------
-
-void MainWindow::on_menuFile_aboutToShow()
-{
-	updateRecents();
-}
-
-
-//-------------------------------------------------
-//  on_actionNew_triggered
-//-------------------------------------------------
-
-void MainWindow::on_actionNew_triggered()
-{
-	startNewWindow();
-}
-
-
-//-------------------------------------------------
-//  on_actionOpen_triggered
-//-------------------------------------------------
-
-void MainWindow::on_actionOpen_triggered()
-{
-	// show the "Open File..." dialog
-	QFileDialog dialog(this);
-	dialog.setFileMode(QFileDialog::ExistingFile);
-	dialog.setNameFilters(buildNameFilters());
-	dialog.exec();
-	if (dialog.result() != QDialog::DialogCode::Accepted)
-		return;
-
-	// try to open the file
-	QString path = dialog.selectedFiles().first();
-	QFile file(path);
-	if (!file.open(QIODevice::ReadOnly))
-		return;
-
-	// and identify it
-	auto identifyResults = Floptool::instance().identify(file);
-	if (identifyResults.empty())
-	{
-		QMessageBox msgBox;
-		msgBox.setText("Unable to open image");
-		msgBox.exec();
-		return;
-	}
-
-	// show the dialog
-	QFileInfo fileInfo(file.fileName());
-	IdentifyDialog identifyDialog(file, identifyResults, this);
-	identifyDialog.setWindowTitle(fileInfo.fileName());
-	if (identifyDialog.exec() != QDialog::Accepted)
-		return;
-
-	// detach the image that we already loaded
-	Floptool::Image::ptr image = identifyDialog.detachImage();
-	if (!image)
-		return;
-
-	// get the format and file system names
-	QString floppyFormatName = image->floppyFormat().name();
-	QString fileSystemName = image->fileSystem().name();
-
-	// and load!
-	loadImage(std::move(image), std::move(path), std::move(floppyFormatName), std::move(fileSystemName));
-}
-
-
-//-------------------------------------------------
-//  on_actionClose_triggered
-//-------------------------------------------------
-
-void MainWindow::on_actionClose_triggered()
-{
-	close();
-}
-
-
-//-------------------------------------------------
-//  on_actionView_triggered
-//-------------------------------------------------
-
-void MainWindow::on_actionView_triggered()
-{
-	ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
-	if (!model)
-		return;
-
-	QModelIndexList indexes = m_ui->mainTree->selectionModel()->selectedRows();
-	for (const QModelIndex &index : indexes)
-	{
-		std::optional<std::vector<uint8_t>> bytes = model->readFile(index);
-		if (bytes)
-		{
-			ViewFileDialog &viewFileDialog = *new ViewFileDialog(this);
-			viewFileDialog.setAttribute(Qt::WA_DeleteOnClose);
-			viewFileDialog.setWindowTitle(model->fileName(index));
-			viewFileDialog.setFileBytes(std::move(*bytes));
-			viewFileDialog.show();
-		}
-	}
-}
-
-
-//-------------------------------------------------
-//  on_actionExtract_triggered
-//-------------------------------------------------
-
-void MainWindow::on_actionExtract_triggered()
-{
-	ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
-	if (!model)
-		return;
-
-	QModelIndexList indexes = m_ui->mainTree->selectionModel()->selectedRows();
-	switch (indexes.size())
-	{
-	case 0:
-		// do nothing; should not happen
-		break;
-
-	case 1:
-		// single selection; extract one item
-		extractSingle(*model, indexes[0]);
-		break;
-
-	default:
-		// multiple selection; extract multiple items to a directory
-		extractMultiple(*model, indexes);
-		break;
-	}
-}
-
-
-//-------------------------------------------------
-//  on_actionAbout_triggered
-//-------------------------------------------------
-
-void MainWindow::on_actionAbout_triggered()
-{
-	QMessageBox msgBox;
-	msgBox.setText("qfloptool");
-	msgBox.exec();
-}
-
-
-//-------------------------------------------------
-//  on_mainTree_customContextMenuRequested
-//-------------------------------------------------
-
-void MainWindow::on_mainTree_customContextMenuRequested(const QPoint &pos)
-{
-	QMenu popupMenu;
-	addReplicatedAction(popupMenu, *m_ui->actionView);
-	addReplicatedAction(popupMenu, *m_ui->actionExtract);
-
-	// show the popup menu
-	QPoint globalPos = m_ui->mainTree->mapToGlobal(pos);
-	popupMenu.exec(globalPos);
-}
+/***************************************************************************
+
+	mainwindow.cpp
+
+	Main qfloptool window
+
+***************************************************************************/
+
+// qfloptool includes
+#include "mainwindow.h"
+#include "./ui_mainwindow.h"
+#include "extractor.h"
+#include "floptool.h"
+#include "imageitemmodel.h"
+#include "dialogs/find.h"
+#include "dialogs/identify.h"
+#include "dialogs/viewfile.h"
+
+// Qt includes
+#include <QCloseEvent>
+#include <QEventLoop>
+#include <QFileDialog>
+#include <QFontDatabase>
+#include <QFutureWatcher>
+#include <QHeaderView>
+#include <QLocale>
+#include <QMessageBox>
+#include <QMenu>
+#include <QPointer>
+#include <QProgressDialog>
+#include <QScrollBar>
+#include <QSettings>
+#include <QTimer>
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+MainWindow::MainWindow(QWidget *parent)
+    : QMainWindow(parent)
+    , m_isExtracting(false)
+{
+	m_ui = std::make_unique<Ui::MainWindow>();
+    m_ui->setupUi(this);
+
+	// cosmetic (why can't this be done in mainwindow.ui?)
+	QFont font = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+	m_ui->mainTree->setFont(font);
+
+	// set up recent actions
+	for (auto i = 0; i < std::size(m_recentActions); i++)
+	{	
+		m_recentActions[i] = new QAction(this);
+		m_ui->menuFile->insertAction(m_ui->actionClose, m_recentActions[i]);
+		connect(m_recentActions[i], &QAction::triggered, this, [this, i]()
+		{
+			loadRecent(i);
+		});
+	}
+
+	// set up the separator after recent actions
+	QAction &separator = *m_ui->menuFile->insertSeparator(m_ui->actionClose);
+	connect(&separator, &QAction::visibleChanged, this, [this, &separator]()
+	{
+		separator.setVisible(m_recentActions[0]->isVisible());
+	});
+
+	// rows start out in the order on the image; clicking a header a third time goes back to it
+	m_ui->mainTree->header()->setSortIndicatorClearable(true);
+	m_ui->mainTree->header()->setSortIndicator(-1, Qt::AscendingOrder);
+	m_ui->mainTree->setSortingEnabled(true);
+
+	// handle folder expansion events
+	connect(m_ui->mainTree, &QTreeView::doubleClicked, this, [this](const QModelIndex &index)
+	{
+		ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
+		if (model)
+			model->loadItem(index);
+	});
+	connect(m_ui->mainTree, &QTreeView::expanded, this, [this](const QModelIndex &index)
+	{
+		ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
+		if (model)
+			model->setExpanded(index, true);
+		prefetchVisibleItems();
+	});
+	connect(m_ui->mainTree, &QTreeView::collapsed, this, [this](const QModelIndex &index)
+	{
+		ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
+		if (model)
+			model->setExpanded(index, false);
+	});
+
+	// whatever scrolls into view gets loaded in the background first
+	connect(m_ui->mainTree->verticalScrollBar(), &QScrollBar::valueChanged, this, [this]()
+	{
+		prefetchVisibleItems();
+	});
+
+	// update the title
+	setTitleFromImageInfo();
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+MainWindow::~MainWindow()
+{
+}
+
+
+//-------------------------------------------------
+//  startNewWindow
+//-------------------------------------------------
+
+MainWindow &MainWindow::startNewWindow()
+{
+	MainWindow &newWindow = *new MainWindow();
+	newWindow.setAttribute(Qt::WA_DeleteOnClose);
+	newWindow.show();
+	return newWindow;
+}
+
+
+//-------------------------------------------------
+//  closeEvent
+//-------------------------------------------------
+
+void MainWindow::closeEvent(QCloseEvent *event)
+{
+	// an extraction's local event loop is still running on our stack; the user has to
+	// cancel it first
+	if (m_isExtracting)
+		event->ignore();
+	else
+		QMainWindow::closeEvent(event);
+}
+
+
+//-------------------------------------------------
+//  buildNameFilters
+//-------------------------------------------------
+
+QStringList MainWindow::buildNameFilters()
+{
+	QStringList results;
+	results << "All files(*)";
+
+	for (const auto &floppyFormatCategory : Floptool::instance().floppyFormats())
+	{
+		for (const Floptool::FloppyFormat &floppyFormat : floppyFormatCategory)
+		{
+			QString extensions;
+			for (const QString &ext : floppyFormat.fileExtensions())
+			{
+				if (!extensions.isEmpty())
+					extensions.append(" ");
+				extensions.append("*.");
+				extensions.append(ext);
+			}
+			results << QString("%1: %2 (%3)").arg(floppyFormatCategory.categoryName(), floppyFormat.description(), extensions);
+		}
+	}
+	return results;
+}
+
+
+//-------------------------------------------------
+//  updateRecents
+//-------------------------------------------------
+
+void MainWindow::updateRecents()
+{
+	QSettings settings;
+
+	bool atEnd = false;
+	for (int i = 0; i < std::size(m_recentActions); i++)
+	{
+		if (!atEnd)
+		{
+			QString settingName = recentFileSettingName(i);
+			QString settingValue = settings.value(settingName).toString();
+			QString thisFileName, thisFloppyFormatName, thisFileSystemName;
+			atEnd = !parseRecentFileSettingValue(settingValue, thisFileName, thisFloppyFormatName, thisFileSystemName);
+			if (!atEnd)
+				m_recentActions[i]->setText(QFileInfo(thisFileName).fileName());
+		}
+		m_recentActions[i]->setVisible(!atEnd);
+	}
+}
+
+
+//-------------------------------------------------
+//  loadRecent
+//-------------------------------------------------
+
+bool MainWindow::loadRecent(int i)
+{
+	// find the recent file out of settings
+	QSettings settings;
+	QString settingName = recentFileSettingName(i);
+	QString settingValue = settings.value(settingName).toString();
+	QString fileName, floppyFormatName, fileSystemName;
+	if (!parseRecentFileSettingValue(settingValue, fileName, floppyFormatName, fileSystemName))
+		return false;
+
+	// find the actual format and file system
+	const Floptool::FloppyFormat *floppyFormat = Floptool::instance().findFloppyFormat(floppyFormatName);
+	if (!floppyFormat)
+		return false;
+	const Floptool::FileSystem *fileSystem = Floptool::instance().findFileSystem(fileSystemName);
+	if (!fileSystem)
+		return false;
+
+	// open the file
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	// mount the image
+	Floptool::Image::ptr image = Floptool::instance().mount(file, *floppyFormat, *fileSystem);
+	if (!image)
+		return false;
+
+	// and load it!
+	return loadImage(std::move(image), std::move(fileName), std::move(floppyFormatName), std::move(fileSystemName));
+}
+
+
+//-------------------------------------------------
+//  loadImage
+//-------------------------------------------------
+
+bool MainWindow::loadImage(Floptool::Image::ptr &&image, QString &&fileName, QString &&floppyFormatName, QString &&fileSystemName)
+{
+	// an extraction in progress is still reading the current image
+	if (m_isExtracting)
+		return false;
+
+	// set the model; the old one goes away, and with it anything still tied to its image
+	QAbstractItemModel *oldModel = m_ui->mainTree->model();
+	ImageItemModel &previewModel = *new ImageItemModel(std::move(image), this);
+	previewModel.setFilterText(m_ui->filterLineEdit->text());
+	m_ui->mainTree->setModel(&previewModel);
+	if (oldModel)
+		oldModel->deleteLater();
+
+	// newly loaded rows may push other directories into view
+	connect(&previewModel, &QAbstractItemModel::rowsInserted, this, [this]()
+	{
+		prefetchVisibleItems();
+	});
+
+	// for some reason, the signal needs to be set up here
+	connect(m_ui->mainTree->selectionModel(), &QItemSelectionModel::selectionChanged, this, [this](const QItemSelection &selected, const QItemSelection &deselected)
+	{
+		m_ui->actionView->setEnabled(!selected.indexes().isEmpty());
+		m_ui->actionExtract->setEnabled(!selected.indexes().isEmpty());
+	});
+
+	// update the title
+	setTitleFromImageInfo(fileName);
+	m_ui->actionExtractToArchive->setEnabled(true);
+	m_ui->actionFind->setEnabled(true);
+
+	// resize all columns
+	int columnCount = previewModel.columnCount();
+	for (int column = 0; column < columnCount; column++)
+		m_ui->mainTree->resizeColumnToContents(column);
+
+	// and add this to recent files
+	addRecent(fileName, std::move(floppyFormatName), std::move(fileSystemName));
+	prefetchVisibleItems();
+	return true;
+}
+
+
+//-------------------------------------------------
+//  prefetchVisibleItems
+//-------------------------------------------------
+
+void MainWindow::prefetchVisibleItems()
+{
+	ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
+	if (!model)
+		return;
+
+	// gather the rows that are on screen, top to bottom
+	QTreeView &tree = *m_ui->mainTree;
+	QModelIndexList visibleIndexes;
+	for (QModelIndex index = tree.indexAt(QPoint(0, 0)); index.isValid() && tree.visualRect(index).top() < tree.viewport()->height(); index = tree.indexBelow(index))
+		visibleIndexes.push_back(index);
+	model->prefetch(visibleIndexes);
+}
+
+
+//-------------------------------------------------
+//  jumpToPath
+//-------------------------------------------------
+
+void MainWindow::jumpToPath(const std::vector<std::string> &path)
+{
+	ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
+	if (!model)
+		return;
+
+	// this loads the directories leading up to the path, and nothing else
+	QModelIndex index = model->indexFromPath(path);
+	if (!index.isValid())
+		return;
+
+	for (QModelIndex parent = index.parent(); parent.isValid(); parent = parent.parent())
+		m_ui->mainTree->expand(parent);
+	m_ui->mainTree->setCurrentIndex(index);
+	m_ui->mainTree->scrollTo(index);
+}
+
+
+//-------------------------------------------------
+//  addRecent
+//-------------------------------------------------
+
+void MainWindow::addRecent(const QString &fileName, QString &&floppyFormatName, QString &&fileSystemName)
+{
+	QSettings settings;
+	QString lastFileName = fileName;
+	for (int i = 0; i < std::size(m_recentActions); i++)
+	{
+		// identify the setting name and get the current value
+		QString settingName = recentFileSettingName(i);
+		QString settingValue = settings.value(settingName).toString();
+		QString thisFileName, thisFloppyFormatName, thisFileSystemName;
+		parseRecentFileSettingValue(settingValue, thisFileName, thisFloppyFormatName, thisFileSystemName);
+
+		// set the new value
+		QString newSettingValue = QString("%1,%2,%3").arg(floppyFormatName, fileSystemName, lastFileName);
+		settings.setValue(settingName, newSettingValue);
+
+		// if its time to bail, do so
+		if (thisFileName == fileName)
+			break;
+
+		// advance
+		lastFileName = std::move(thisFileName);
+		floppyFormatName = std::move(thisFloppyFormatName);
+		fileSystemName = std::move(thisFileSystemName);
+	}
+}
+
+
+//-------------------------------------------------
+//  parseRecentFileSettingValue
+//-------------------------------------------------
+
+bool MainWindow::parseRecentFileSettingValue(const QString &settingValue, QString &fileName, QString &floppyFormatName, QString &fileSystemName)
+{
+	qsizetype firstCommaPos = settingValue.indexOf(',', 0);
+	if (firstCommaPos < 0)
+		return false;
+	qsizetype secondCommaPos = settingValue.indexOf(',', firstCommaPos + 1);
+	if (secondCommaPos < 0 || secondCommaPos >= settingValue.size() - 1)
+		return false;
+
+	floppyFormatName = settingValue.left(firstCommaPos);
+	fileSystemName = settingValue.mid(firstCommaPos + 1, secondCommaPos - firstCommaPos - 1);
+	fileName = settingValue.right(settingValue.size() - secondCommaPos - 1);
+	return true;
+}
+
+
+//-------------------------------------------------
+//  recentFileSettingName
+//-------------------------------------------------
+
+QString MainWindow::recentFileSettingName(int i)
+{
+	return QString("recentfiles/%1").arg(i);
+}
+
+
+//-------------------------------------------------
+//  setTitleFromImageInfo
+//-------------------------------------------------
+
+void MainWindow::setTitleFromImageInfo(const QString &fileName)
+{
+	QString title = QCoreApplication::applicationName();
+	if (!fileName.isEmpty())
+		title += QString(" - %1").arg(QFileInfo(fileName).fileName());
+
+	ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
+	if (model && model->image())
+	{
+		std::optional<QString> volumeName = model->image()->volumeName();
+		if (volumeName)
+			title += QString(" (\"%1\")").arg(*volumeName);
+	}
+	setWindowTitle(title);
+}
+
+
+//-------------------------------------------------
+//  extractSingle
+//-------------------------------------------------
+
+void MainWindow::extractSingle(ImageItemModel &model, const QModelIndex &index)
+{
+	QString defaultFileName = model.fileName(index);
+	if (defaultFileName.isEmpty())
+		return;
+
+	QFileDialog fileDialog;
+	fileDialog.setWindowTitle("Extract");
+	fileDialog.setAcceptMode(QFileDialog::AcceptSave);
+	fileDialog.setFileMode(QFileDialog::AnyFile);
+	fileDialog.selectFile(defaultFileName);
+	if (fileDialog.exec() != QDialog::Accepted)
+		return;
+
+	QString saveFileName = fileDialog.selectedFiles()[0];
+	Extractor extractor(*model.image());
+	extractor.add(model.pathOnImage(index), std::move(saveFileName));
+	runExtractor(extractor);
+}
+
+
+//-------------------------------------------------
+//  extractMultiple
+//-------------------------------------------------
+
+void MainWindow::extractMultiple(ImageItemModel &model, const QModelIndexList &indexes)
+{
+	QString path = QFileDialog::getExistingDirectory(this, "Extract");
+	if (path.isEmpty())
+		return;
+
+	// everything goes out as one job, so that there is one progress dialog and one cancel
+	Extractor extractor(*model.image());
+	for (const QModelIndex &index : indexes)
+		extractor.add(model.pathOnImage(index), QString("%1/%2").arg(path, model.fileName(index)));
+	runExtractor(extractor);
+}
+
+
+//-------------------------------------------------
+//  runExtractor
+//-------------------------------------------------
+
+bool MainWindow::runExtractor(Extractor &extractor)
+{
+	// the extraction happens in the background while we sit in a local event loop; the
+	// window modal progress dialog goes up right away to keep the user off of the window,
+	// and m_isExtracting covers whatever can still reach us (closing the window, other
+	// windows, the Find dialog) so that nothing replaces the image out from under us
+	QProgressDialog progressDialog("Scanning...", "Cancel", 0, 0, this);
+	progressDialog.setWindowTitle("Extract");
+	progressDialog.setWindowModality(Qt::WindowModal);
+	progressDialog.setMinimumDuration(0);
+	progressDialog.show();
+	connect(&progressDialog, &QProgressDialog::canceled, &progressDialog, [&extractor]()
+	{
+		extractor.cancel();
+	});
+
+	QTimer timer;
+	timer.setInterval(100);
+	connect(&timer, &QTimer::timeout, &progressDialog, [&extractor, &progressDialog]()
+	{
+		Extractor::Progress progress = extractor.progress();
+		if (!progress.m_isScanning && !progressDialog.wasCanceled())
+		{
+			QLocale locale;
+			progressDialog.setMaximum(std::max(progress.m_totalFileCount, 1));
+			progressDialog.setValue(progress.m_fileCount);
+			progressDialog.setLabelText(QString("Extracting %1 of %2 files (%3 of %4)").arg(
+				QString::number(progress.m_fileCount),
+				QString::number(progress.m_totalFileCount),
+				locale.formattedDataSize(progress.m_byteCount),
+				locale.formattedDataSize(progress.m_totalByteCount)));
+		}
+	});
+
+	QEventLoop eventLoop;
+	QFutureWatcher<void> watcher;
+	connect(&watcher, &QFutureWatcher<void>::finished, &eventLoop, &QEventLoop::quit);
+	m_isExtracting = true;
+	watcher.setFuture(extractor.start());
+	timer.start();
+	eventLoop.exec();
+	timer.stop();
+	m_isExtracting = false;
+	bool wasCanceled = progressDialog.wasCanceled();
+	progressDialog.reset();
+
+	// let the user know if anything went wrong
+	Extractor::Progress progress = extractor.progress();
+	if (progress.m_errorCount > 0 && !wasCanceled)
+	{
+		QMessageBox msgBox(this);
+		msgBox.setText(QString("%1 item(s) could not be extracted").arg(progress.m_errorCount));
+		msgBox.exec();
+	}
+	return !wasCanceled;
+}
+
+
+//-------------------------------------------------
+//  addReplicatedAction
+//-------------------------------------------------
+
+QAction &MainWindow::addReplicatedAction(QMenu &menu, QAction &existingAction)
+{
+	QAction &newAction = *menu.addAction(existingAction.text(), [&existingAction] { existingAction.triggered(); });
+	newAction.setEnabled(existingAction.isEnabled());
+	return newAction;
+}
+
+
+//-------------------------------------------------
+//  on_menuFile_aboutToShow
+//-------------------------------------------------
+
+void MainWindow::on_menuFile_aboutToShow()
+{
+	updateRecents();
+}
+
+
+//-------------------------------------------------
+//  on_actionNew_triggered
+//-------------------------------------------------
+
+void MainWindow::on_actionNew_triggered()
+{
+	startNewWindow();
+}
+
+
+//-------------------------------------------------
+//  on_actionOpen_triggered
+//-------------------------------------------------
+
+void MainWindow::on_actionOpen_triggered()
+{
+	// show the "Open File..." dialog
+	QFileDialog dialog(this);
+	dialog.setFileMode(QFileDialog::ExistingFile);
+	dialog.setNameFilters(buildNameFilters());
+	dialog.exec();
+	if (dialog.result() != QDialog::DialogCode::Accepted)
+		return;
+
+	// try to open the file
+	QString path = dialog.selectedFiles().first();
+	QFile file(path);
+	if (!file.open(QIODevice::ReadOnly))
+		return;
+
+	// map it, and identify it
+	MappedFile::ptr mappedFile = MappedFile::open(file);
+	auto identifyResults = Floptool::instance().identify(*mappedFile);
+	if (identifyResults.empty())
+	{
+		QMessageBox msgBox;
+		msgBox.setText("Unable to open image");
+		msgBox.exec();
+		return;
+	}
+
+	// show the dialog
+	QFileInfo fileInfo(file.fileName());
+	IdentifyDialog identifyDialog(std::move(mappedFile), identifyResults, this);
+	identifyDialog.setWindowTitle(fileInfo.fileName());
+	if (identifyDialog.exec() != QDialog::Accepted)
+		return;
+
+	// detach the image that we already loaded
+	Floptool::Image::ptr image = identifyDialog.detachImage();
+	if (!image)
+		return;
+
+	// get the format and file system names
+	QString floppyFormatName = image->floppyFormat().name();
+	QString fileSystemName = image->fileSystem().name();
+
+	// and load!
+	loadImage(std::move(image), std::move(path), std::move(floppyFormatName), std::move(fileSystemName));
+}
+
+
+//-------------------------------------------------
+//  on_actionClose_triggered
+//-------------------------------------------------
+
+void MainWindow::on_actionClose_triggered()
+{
+	close();
+}
+
+
+//-------------------------------------------------
+//  on_actionView_triggered
+//-------------------------------------------------
+
+void MainWindow::on_actionView_triggered()
+{
+	ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
+	if (!model)
+		return;
+
+	QModelIndexList indexes = m_ui->mainTree->selectionModel()->selectedRows();
+	for (const QModelIndex &index : indexes)
+	{
+		std::optional<std::vector<uint8_t>> bytes = model->readFile(index);
+		if (bytes)
+		{
+			ViewFileDialog &viewFileDialog = *new ViewFileDialog(this);
+			viewFileDialog.setAttribute(Qt::WA_DeleteOnClose);
+			viewFileDialog.setWindowTitle(model->fileName(index));
+			viewFileDialog.setFileBytes(std::move(*bytes));
+			viewFileDialog.show();
+		}
+	}
+}
+
+
+//-------------------------------------------------
+//  on_actionExtract_triggered
+//-------------------------------------------------
+
+void MainWindow::on_actionExtract_triggered()
+{
+	ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
+	if (!model || m_isExtracting)
+		return;
+
+	QModelIndexList indexes = m_ui->mainTree->selectionModel()->selectedRows();
+	switch (indexes.size())
+	{
+	case 0:
+		// do nothing; should not happen
+		break;
+
+	case 1:
+		// single selection; extract one item
+		extractSingle(*model, indexes[0]);
+		break;
+
+	default:
+		// multiple selection; extract multiple items to a directory
+		extractMultiple(*model, indexes);
+		break;
+	}
+}
+
+
+//-------------------------------------------------
+//  on_actionExtractToArchive_triggered
+//-------------------------------------------------
+
+void MainWindow::on_actionExtractToArchive_triggered()
+{
+	ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
+	if (!model || m_isExtracting)
+		return;
+
+	// with nothing selected, the whole image goes into the archive
+	QModelIndexList indexes = m_ui->mainTree->selectionModel()->selectedRows();
+	QString defaultFileName = indexes.size() == 1
+		? model->fileName(indexes[0])
+		: model->image()->volumeName().value_or(QString());
+
+	QString selectedFilter;
+	QString archiveFileName = QFileDialog::getSaveFileName(this, "Extract to Archive", defaultFileName, "ZIP archives (*.zip);;Tar archives (*.tar)", &selectedFilter);
+	if (archiveFileName.isEmpty())
+		return;
+
+	// the extension wins over the filter, if there is one
+	bool isTar = selectedFilter.contains("*.tar");
+	if (archiveFileName.endsWith(".tar", Qt::CaseInsensitive))
+		isTar = true;
+	else if (archiveFileName.endsWith(".zip", Qt::CaseInsensitive))
+		isTar = false;
+	else
+		archiveFileName += isTar ? ".tar" : ".zip";
+
+	QFile file(archiveFileName);
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		QMessageBox msgBox(this);
+		msgBox.setText(QString("Unable to create \"%1\"").arg(QFileInfo(archiveFileName).fileName()));
+		msgBox.exec();
+		return;
+	}
+
+	// files go straight from the image into the archive, without landing on the host
+	Extractor extractor(*model->image(), isTar ? ArchiveWriter::createTar(file) : ArchiveWriter::createZip(file));
+	if (indexes.isEmpty())
+		extractor.add({}, QString());
+	for (const QModelIndex &index : indexes)
+		extractor.add(model->pathOnImage(index), model->fileName(index));
+	bool isComplete = runExtractor(extractor);
+
+	// a cancelled archive is missing things, so it is not worth keeping
+	file.close();
+	if (!isComplete)
+		file.remove();
+}
+
+
+//-------------------------------------------------
+//  on_actionFind_triggered
+//-------------------------------------------------
+
+void MainWindow::on_actionFind_triggered()
+{
+	QPointer<ImageItemModel> model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
+	if (!model)
+		return;
+
+	// the index builds in the background; the dialog shows its progress
+	FindDialog &findDialog = *new FindDialog(model->searchIndex(), this);
+	findDialog.setAttribute(Qt::WA_DeleteOnClose);
+
+	// results are only good for the image they came from, so the dialog closes when that
+	// image is replaced
+	connect(model.data(), &QObject::destroyed, &findDialog, &QWidget::close);
+	connect(&findDialog, &FindDialog::pathActivated, this, [this, model](const std::vector<std::string> &path)
+	{
+		if (model && m_ui->mainTree->model() == model.data())
+			jumpToPath(path);
+	});
+	findDialog.show();
+}
+
+
+//-------------------------------------------------
+//  on_actionAbout_triggered
+//-------------------------------------------------
+
+void MainWindow::on_actionAbout_triggered()
+{
+	QMessageBox msgBox;
+	msgBox.setText("qfloptool");
+	msgBox.exec();
+}
+
+
+//-------------------------------------------------
+//  on_mainTree_customContextMenuRequested
+//-------------------------------------------------
+
+void MainWindow::on_mainTree_customContextMenuRequested(const QPoint &pos)
+{
+	QMenu popupMenu;
+	addReplicatedAction(popupMenu, *m_ui->actionView);
+	addReplicatedAction(popupMenu, *m_ui->actionExtract);
+	addReplicatedAction(popupMenu, *m_ui->actionExtractToArchive);
+
+	// show the popup menu
+	QPoint globalPos = m_ui->mainTree->mapToGlobal(pos);
+	popupMenu.exec(globalPos);
+}
+
+
+//-------------------------------------------------
+//  on_filterLineEdit_textChanged
+//-------------------------------------------------
+
+void MainWindow::on_filterLineEdit_textChanged(const QString &text)
+{
+	ImageItemModel *model = dynamic_cast<ImageItemModel *>(m_ui->mainTree->model());
+	if (model)
+		model->setFilterText(text);
+
+	// rows that were filtered out may now be on screen
+	prefetchVisibleItems();
+}
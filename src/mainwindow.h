@@ -1,73 +1,86 @@
-/***************************************************************************
-
-	mainwindow.h
-
-	Main qfloptool window
-
-***************************************************************************/
-
-#ifndef MAINWINDOW_H
-#define MAINWINDOW_H
-
-// qfloptool headers
-#include "floptool.h"
-
-// Qt headers
-#include <QMainWindow>
-#include <QModelIndex>
-
-
-class ImageItemModel;
-
-QT_BEGIN_NAMESPACE
-namespace Ui { class MainWindow; }
-class QSettings;
-QT_END_NAMESPACE
-
-
-//**************************************************************************
-//  TYPE DEFINITIONS
-//**************************************************************************
-
-// ======================> MainWindow
-
-class MainWindow : public QMainWindow
-{
-    Q_OBJECT
-
-public:
-	// ctor/dtor
-    MainWindow(QWidget *parent = nullptr);
-    ~MainWindow();
-
-	// methods
-	static MainWindow &startNewWindow();
-
-private slots:
-	void on_menuFile_aboutToShow();
-	void on_actionNew_triggered();
-	void on_actionOpen_triggered();
-	void on_actionClose_triggered();
-	void on_actionView_triggered();
-	void on_actionExtract_triggered();
-	void on_actionAbout_triggered();
-	void on_mainTree_customContextMenuRequested(const QPoint &pos);
-
-private:
-	std::unique_ptr<Ui::MainWindow> m_ui;
-	std::array<QAction *, 10>		m_recentActions;
-
-	QStringList buildNameFilters();
-	void updateRecents();
-	bool loadRecent(int i);
-	bool loadImage(Floptool::Image::ptr &&image, QString &&fileName, QString &&floppyFormatName, QString &&fileSystemName);
-	void addRecent(const QString &fileName, QString &&floppyFormatName, QString &&fileSystemName);
-	static bool parseRecentFileSettingValue(const QString &settingValue, QString &fileName, QString &floppyFormatName, QString &fileSystemName);
-	static QString recentFileSettingName(int i);
-	void setTitleFromImageInfo(const QString &fileName = "");
-	void extractSingle(ImageItemModel &model, const QModelIndex &index);
-	void extractMultiple(ImageItemModel &model, const QModelIndexList &indexes);
-	static QAction &addReplicatedAction(QMenu &menu, QAction &existingAction);
-};
-
-#endif // MAINWINDOW_H
+/***************************************************************************
+
+	mainwindow.h
+
+	Main qfloptool window
+
+***************************************************************************/
+
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+// qfloptool headers
+#include "floptool.h"
+
+// Qt headers
+#include <QMainWindow>
+#include <QModelIndex>
+
+
+class Extractor;
+class ImageItemModel;
+
+QT_BEGIN_NAMESPACE
+namespace Ui { class MainWindow; }
+class QCloseEvent;
+class QSettings;
+QT_END_NAMESPACE
+
+
+//**************************************************************************
+//  TYPE DEFINITIONS
+//**************************************************************************
+
+// ======================> MainWindow
+
+class MainWindow : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+	// ctor/dtor
+    MainWindow(QWidget *parent = nullptr);
+    ~MainWindow();
+
+	// methods
+	static MainWindow &startNewWindow();
+
+protected:
+	// virtuals
+	virtual void closeEvent(QCloseEvent *event) override;
+
+private slots:
+	void on_menuFile_aboutToShow();
+	void on_actionNew_triggered();
+	void on_actionOpen_triggered();
+	void on_actionClose_triggered();
+	void on_actionView_triggered();
+	void on_actionExtract_triggered();
+	void on_actionExtractToArchive_triggered();
+	void on_actionFind_triggered();
+	void on_actionAbout_triggered();
+	void on_mainTree_customContextMenuRequested(const QPoint &pos);
+	void on_filterLineEdit_textChanged(const QString &text);
+
+private:
+	std::unique_ptr<Ui::MainWindow> m_ui;
+	std::array<QAction *, 10>		m_recentActions;
+	bool							m_isExtracting;
+
+	QStringList buildNameFilters();
+	void updateRecents();
+	bool loadRecent(int i);
+	bool loadImage(Floptool::Image::ptr &&image, QString &&fileName, QString &&floppyFormatName, QString &&fileSystemName);
+	void addRecent(const QString &fileName, QString &&floppyFormatName, QString &&fileSystemName);
+	static bool parseRecentFileSettingValue(const QString &settingValue, QString &fileName, QString &floppyFormatName, QString &fileSystemName);
+	static QString recentFileSettingName(int i);
+	void setTitleFromImageInfo(const QString &fileName = "");
+	void extractSingle(ImageItemModel &model, const QModelIndex &index);
+	void extractMultiple(ImageItemModel &model, const QModelIndexList &indexes);
+	bool runExtractor(Extractor &extractor);
+	void prefetchVisibleItems();
+	void jumpToPath(const std::vector<std::string> &path);
+	static QAction &addReplicatedAction(QMenu &menu, QAction &existingAction);
+};
+
+#endif // MAINWINDOW_H
@@ -1,188 +1,188 @@
-// Generated file, edition is futile
-
-#ifndef GENERATED_HAS_FORMATS_H
-#define GENERATED_HAS_FORMATS_H
-
-#define HAS_FORMATS_COCO_RAWDSK
-#define HAS_FORMATS_PRIMOPTP
-#define HAS_FORMATS_A5105_DSK
-#define HAS_FORMATS_BASICDSK
-#define HAS_FORMATS_MBEE_CAS
-#define HAS_FORMATS_PC98FDI_DSK
-#define HAS_FORMATS_ABC1600_DSK
-#define HAS_FORMATS_FMSX_CAS
-#define HAS_FORMATS_AMI_DSK
-#define HAS_FORMATS_NFD_DSK
-#define HAS_FORMATS_FS_CBMDOS
-#define HAS_FORMATS_APPLIX_DSK
-#define HAS_FORMATS_HECT_DSK
-#define HAS_FORMATS_DVK_MX_DSK
-#define HAS_FORMATS_FSD_DSK
-#define HAS_FORMATS_ORIC_TAP
-#define HAS_FORMATS_ACORN_DSK
-#define HAS_FORMATS_NASCOM_DSK
-#define HAS_FORMATS_RX50_DSK
-#define HAS_FORMATS_DMK_DSK
-#define HAS_FORMATS_IBMXDF_DSK
-#define HAS_FORMATS_X07_CAS
-#define HAS_FORMATS_HP300_DSK
-#define HAS_FORMATS_CGEN_CAS
-#define HAS_FORMATS_MS0515_DSK
-#define HAS_FORMATS_NANOS_DSK
-#define HAS_FORMATS_CAMPLYNX_DSK
-#define HAS_FORMATS_SMX_DSK
-#define HAS_FORMATS_ORAO_CAS
-#define HAS_FORMATS_FC100_CAS
-#define HAS_FORMATS_BW12_DSK
-#define HAS_FORMATS_CAMPLYNX_CAS
-#define HAS_FORMATS_ATOM_TAP
-#define HAS_FORMATS_HP_IPC_DSK
-#define HAS_FORMATS_HECT_TAP
-#define HAS_FORMATS_OPD_DSK
-#define HAS_FORMATS_KIM1_CAS
-#define HAS_FORMATS_AP_DSK35
-#define HAS_FORMATS_C4040_DSK
-#define HAS_FORMATS_FS_FAT
-#define HAS_FORMATS_QL_DSK
-#define HAS_FORMATS_VT_CAS
-#define HAS_FORMATS_FS_ORIC_JASMIN
-#define HAS_FORMATS_CD90_640_DSK
-#define HAS_FORMATS_FL1_DSK
-#define HAS_FORMATS_EXCALI64_DSK
-#define HAS_FORMATS_HECTOR_MINIDISC
-#define HAS_FORMATS_XDF_DSK
-#define HAS_FORMATS_BW2_DSK
-#define HAS_FORMATS_SDF_DSK
-#define HAS_FORMATS_OS9_DSK
-#define HAS_FORMATS_COMX35_DSK
-#define HAS_FORMATS_FDOS_DSK
-#define HAS_FORMATS_MDOS_DSK
-#define HAS_FORMATS_IQ151_DSK
-#define HAS_FORMATS_ACE_TAP
-#define HAS_FORMATS_G64_DSK
-#define HAS_FORMATS_KAYPRO_DSK
-#define HAS_FORMATS_D64_DSK
-#define HAS_FORMATS_FS_VTECH
-#define HAS_FORMATS_TZX_CAS
-#define HAS_FORMATS_AQUARIUS_CAQ
-#define HAS_FORMATS_DMV_DSK
-#define HAS_FORMATS_NES_DSK
-#define HAS_FORMATS_D71_DSK
-#define HAS_FORMATS_ESQ16_DSK
-#define HAS_FORMATS_AS_DSK
-#define HAS_FORMATS_SORC_CAS
-#define HAS_FORMATS_ABCFD2_DSK
-#define HAS_FORMATS_DS9_DSK
-#define HAS_FORMATS_MTX_DSK
-#define HAS_FORMATS_PHC25_CAS
-#define HAS_FORMATS_SORD_CAS
-#define HAS_FORMATS_FS_COCO_OS9
-#define HAS_FORMATS_X1_TAP
-#define HAS_FORMATS_CBM_TAP
-#define HAS_FORMATS_DIP_DSK
-#define HAS_FORMATS_TRD_DSK
-#define HAS_FORMATS_DIM_DSK
-#define HAS_FORMATS_M5_DSK
-#define HAS_FORMATS_AIM_DSK
-#define HAS_FORMATS_H8_CAS
-#define HAS_FORMATS_THOM_DSK
-#define HAS_FORMATS_ADAM_DSK
-#define HAS_FORMATS_D81_DSK
-#define HAS_FORMATS_JVC_DSK
-#define HAS_FORMATS_MZ_CAS
-#define HAS_FORMATS_P2000T_CAS
-#define HAS_FORMATS_D82_DSK
-#define HAS_FORMATS_TIM011_DSK
-#define HAS_FORMATS_ITT3030_DSK
-#define HAS_FORMATS_KC_CAS
-#define HAS_FORMATS_AFS_DSK
-#define HAS_FORMATS_COUPEDSK
-#define HAS_FORMATS_FS_ISIS
-#define HAS_FORMATS_FM7_CAS
-#define HAS_FORMATS_FS_COCO_RSDOS
-#define HAS_FORMATS_FS_HPLIF
-#define HAS_FORMATS_PK8020_DSK
-#define HAS_FORMATS_ZX81_P
-#define HAS_FORMATS_CCVF_DSK
-#define HAS_FORMATS_WD177X_DSK
-#define HAS_FORMATS_VT_DSK
-#define HAS_FORMATS_RK_CAS
-#define HAS_FORMATS_EP64_DSK
-#define HAS_FORMATS_CBM_CRT
-#define HAS_FORMATS_POLY_DSK
-#define HAS_FORMATS_HTI_TAP
-#define HAS_FORMATS_APD_DSK
-#define HAS_FORMATS_VICTOR9K_DSK
-#define HAS_FORMATS_ST_DSK
-#define HAS_FORMATS_VG5K_CAS
-#define HAS_FORMATS_FMTOWNS_DSK
-#define HAS_FORMATS_PMD_CAS
-#define HAS_FORMATS_VECTOR06_DSK
-#define HAS_FORMATS_CP68_DSK
-#define HAS_FORMATS_VDK_DSK
-#define HAS_FORMATS_GUAB_DSK
-#define HAS_FORMATS_ABC800_DSK
-#define HAS_FORMATS_JUKU_DSK
-#define HAS_FORMATS_PPG_DSK
-#define HAS_FORMATS_UEF_CAS
-#define HAS_FORMATS_GTP_CAS
-#define HAS_FORMATS_TVC_DSK
-#define HAS_FORMATS_AGAT840K_HLE_DSK
-#define HAS_FORMATS_TVC_CAS
-#define HAS_FORMATS_SVI_CAS
-#define HAS_FORMATS_SF7000_DSK
-#define HAS_FORMATS_MFM_HD
-#define HAS_FORMATS_C8280_DSK
-#define HAS_FORMATS_TIKI100_DSK
-#define HAS_FORMATS_TI99_DSK
-#define HAS_FORMATS_A26_CAS
-#define HAS_FORMATS_TANDY2K_DSK
-#define HAS_FORMATS_SWD_DSK
-#define HAS_FORMATS_CGENIE_DSK
-#define HAS_FORMATS_M20_DSK
-#define HAS_FORMATS_SVI_DSK
-#define HAS_FORMATS_SPC1000_CAS
-#define HAS_FORMATS_ATARI_DSK
-#define HAS_FORMATS_SOL_CAS
-#define HAS_FORMATS_TRS_CAS
-#define HAS_FORMATS_APOLLO_DSK
-#define HAS_FORMATS_SC3000_BIT
-#define HAS_FORMATS_RC759_DSK
-#define HAS_FORMATS_PYLDIN_DSK
-#define HAS_FORMATS_MSX_DSK
-#define HAS_FORMATS_MM_DSK
-#define HAS_FORMATS_FS_PRODOS
-#define HAS_FORMATS_CPIS_DSK
-#define HAS_FORMATS_PASTI_DSK
-#define HAS_FORMATS_PC98_DSK
-#define HAS_FORMATS_FLEX_DSK
-#define HAS_FORMATS_CONCEPT_DSK
-#define HAS_FORMATS_C3040_DSK
-#define HAS_FORMATS_THOM_CAS
-#define HAS_FORMATS_ADAM_CAS
-#define HAS_FORMATS_APF_APT
-#define HAS_FORMATS_ASST128_DSK
-#define HAS_FORMATS_CSW_CAS
-#define HAS_FORMATS_P6001_CAS
-#define HAS_FORMATS_ATOM_DSK
-#define HAS_FORMATS_D80_DSK
-#define HAS_FORMATS_ORIC_DSK
-#define HAS_FORMATS_NASLITE_DSK
-#define HAS_FORMATS_AP2_DSK
-#define HAS_FORMATS_TRS80_DSK
-#define HAS_FORMATS_COCO_CAS
-#define HAS_FORMATS_FDD_DSK
-#define HAS_FORMATS_2D_DSK
-#define HAS_FORMATS_UNIFLEX_DSK
-#define HAS_FORMATS_LVIV_LVT
-#define HAS_FORMATS_KC85_DSK
-#define HAS_FORMATS_JFD_DSK
-#define HAS_FORMATS_HPI_DSK
-#define HAS_FORMATS_DCP_DSK
-#define HAS_FORMATS_IMG_DSK
-#define HAS_FORMATS_APRIDISK
-#define HAS_FORMATS_SORC_DSK
-#define HAS_FORMATS_SDD_DSK
-#define HAS_FORMATS_ESQ8_DSK
-
-#endif
+// Generated file, edition is futile
+
+#ifndef GENERATED_HAS_FORMATS_H
+#define GENERATED_HAS_FORMATS_H
+
+#define HAS_FORMATS_COCO_RAWDSK
+#define HAS_FORMATS_PRIMOPTP
+#define HAS_FORMATS_A5105_DSK
+#define HAS_FORMATS_BASICDSK
+#define HAS_FORMATS_MBEE_CAS
+#define HAS_FORMATS_PC98FDI_DSK
+#define HAS_FORMATS_ABC1600_DSK
+#define HAS_FORMATS_FMSX_CAS
+#define HAS_FORMATS_AMI_DSK
+#define HAS_FORMATS_NFD_DSK
+#define HAS_FORMATS_FS_CBMDOS
+#define HAS_FORMATS_APPLIX_DSK
+#define HAS_FORMATS_HECT_DSK
+#define HAS_FORMATS_DVK_MX_DSK
+#define HAS_FORMATS_FSD_DSK
+#define HAS_FORMATS_ORIC_TAP
+#define HAS_FORMATS_ACORN_DSK
+#define HAS_FORMATS_NASCOM_DSK
+#define HAS_FORMATS_RX50_DSK
+#define HAS_FORMATS_DMK_DSK
+#define HAS_FORMATS_IBMXDF_DSK
+#define HAS_FORMATS_X07_CAS
+#define HAS_FORMATS_HP300_DSK
+#define HAS_FORMATS_CGEN_CAS
+#define HAS_FORMATS_MS0515_DSK
+#define HAS_FORMATS_NANOS_DSK
+#define HAS_FORMATS_CAMPLYNX_DSK
+#define HAS_FORMATS_SMX_DSK
+#define HAS_FORMATS_ORAO_CAS
+#define HAS_FORMATS_FC100_CAS
+#define HAS_FORMATS_BW12_DSK
+#define HAS_FORMATS_CAMPLYNX_CAS
+#define HAS_FORMATS_ATOM_TAP
+#define HAS_FORMATS_HP_IPC_DSK
+#define HAS_FORMATS_HECT_TAP
+#define HAS_FORMATS_OPD_DSK
+#define HAS_FORMATS_KIM1_CAS
+#define HAS_FORMATS_AP_DSK35
+#define HAS_FORMATS_C4040_DSK
+#define HAS_FORMATS_FS_FAT
+#define HAS_FORMATS_QL_DSK
+#define HAS_FORMATS_VT_CAS
+#define HAS_FORMATS_FS_ORIC_JASMIN
+#define HAS_FORMATS_CD90_640_DSK
+#define HAS_FORMATS_FL1_DSK
+#define HAS_FORMATS_EXCALI64_DSK
+#define HAS_FORMATS_HECTOR_MINIDISC
+#define HAS_FORMATS_XDF_DSK
+#define HAS_FORMATS_BW2_DSK
+#define HAS_FORMATS_SDF_DSK
+#define HAS_FORMATS_OS9_DSK
+#define HAS_FORMATS_COMX35_DSK
+#define HAS_FORMATS_FDOS_DSK
+#define HAS_FORMATS_MDOS_DSK
+#define HAS_FORMATS_IQ151_DSK
+#define HAS_FORMATS_ACE_TAP
+#define HAS_FORMATS_G64_DSK
+#define HAS_FORMATS_KAYPRO_DSK
+#define HAS_FORMATS_D64_DSK
+#define HAS_FORMATS_FS_VTECH
+#define HAS_FORMATS_TZX_CAS
+#define HAS_FORMATS_AQUARIUS_CAQ
+#define HAS_FORMATS_DMV_DSK
+#define HAS_FORMATS_NES_DSK
+#define HAS_FORMATS_D71_DSK
+#define HAS_FORMATS_ESQ16_DSK
+#define HAS_FORMATS_AS_DSK
+#define HAS_FORMATS_SORC_CAS
+#define HAS_FORMATS_ABCFD2_DSK
+#define HAS_FORMATS_DS9_DSK
+#define HAS_FORMATS_MTX_DSK
+#define HAS_FORMATS_PHC25_CAS
+#define HAS_FORMATS_SORD_CAS
+#define HAS_FORMATS_FS_COCO_OS9
+#define HAS_FORMATS_X1_TAP
+#define HAS_FORMATS_CBM_TAP
+#define HAS_FORMATS_DIP_DSK
+#define HAS_FORMATS_TRD_DSK
+#define HAS_FORMATS_DIM_DSK
+#define HAS_FORMATS_M5_DSK
+#define HAS_FORMATS_AIM_DSK
+#define HAS_FORMATS_H8_CAS
+#define HAS_FORMATS_THOM_DSK
+#define HAS_FORMATS_ADAM_DSK
+#define HAS_FORMATS_D81_DSK
+#define HAS_FORMATS_JVC_DSK
+#define HAS_FORMATS_MZ_CAS
+#define HAS_FORMATS_P2000T_CAS
+#define HAS_FORMATS_D82_DSK
+#define HAS_FORMATS_TIM011_DSK
+#define HAS_FORMATS_ITT3030_DSK
+#define HAS_FORMATS_KC_CAS
+#define HAS_FORMATS_AFS_DSK
+#define HAS_FORMATS_COUPEDSK
+#define HAS_FORMATS_FS_ISIS
+#define HAS_FORMATS_FM7_CAS
+#define HAS_FORMATS_FS_COCO_RSDOS
+#define HAS_FORMATS_FS_HPLIF
+#define HAS_FORMATS_PK8020_DSK
+#define HAS_FORMATS_ZX81_P
+#define HAS_FORMATS_CCVF_DSK
+#define HAS_FORMATS_WD177X_DSK
+#define HAS_FORMATS_VT_DSK
+#define HAS_FORMATS_RK_CAS
+#define HAS_FORMATS_EP64_DSK
+#define HAS_FORMATS_CBM_CRT
+#define HAS_FORMATS_POLY_DSK
+#define HAS_FORMATS_HTI_TAP
+#define HAS_FORMATS_APD_DSK
+#define HAS_FORMATS_VICTOR9K_DSK
+#define HAS_FORMATS_ST_DSK
+#define HAS_FORMATS_VG5K_CAS
+#define HAS_FORMATS_FMTOWNS_DSK
+#define HAS_FORMATS_PMD_CAS
+#define HAS_FORMATS_VECTOR06_DSK
+#define HAS_FORMATS_CP68_DSK
+#define HAS_FORMATS_VDK_DSK
+#define HAS_FORMATS_GUAB_DSK
+#define HAS_FORMATS_ABC800_DSK
+#define HAS_FORMATS_JUKU_DSK
+#define HAS_FORMATS_PPG_DSK
+#define HAS_FORMATS_UEF_CAS
+#define HAS_FORMATS_GTP_CAS
+#define HAS_FORMATS_TVC_DSK
+#define HAS_FORMATS_AGAT840K_HLE_DSK
+#define HAS_FORMATS_TVC_CAS
+#define HAS_FORMATS_SVI_CAS
+#define HAS_FORMATS_SF7000_DSK
+#define HAS_FORMATS_MFM_HD
+#define HAS_FORMATS_C8280_DSK
+#define HAS_FORMATS_TIKI100_DSK
+#define HAS_FORMATS_TI99_DSK
+#define HAS_FORMATS_A26_CAS
+#define HAS_FORMATS_TANDY2K_DSK
+#define HAS_FORMATS_SWD_DSK
+#define HAS_FORMATS_CGENIE_DSK
+#define HAS_FORMATS_M20_DSK
+#define HAS_FORMATS_SVI_DSK
+#define HAS_FORMATS_SPC1000_CAS
+#define HAS_FORMATS_ATARI_DSK
+#define HAS_FORMATS_SOL_CAS
+#define HAS_FORMATS_TRS_CAS
+#define HAS_FORMATS_APOLLO_DSK
+#define HAS_FORMATS_SC3000_BIT
+#define HAS_FORMATS_RC759_DSK
+#define HAS_FORMATS_PYLDIN_DSK
+#define HAS_FORMATS_MSX_DSK
+#define HAS_FORMATS_MM_DSK
+#define HAS_FORMATS_FS_PRODOS
+#define HAS_FORMATS_CPIS_DSK
+#define HAS_FORMATS_PASTI_DSK
+#define HAS_FORMATS_PC98_DSK
+#define HAS_FORMATS_FLEX_DSK
+#define HAS_FORMATS_CONCEPT_DSK
+#define HAS_FORMATS_C3040_DSK
+#define HAS_FORMATS_THOM_CAS
+#define HAS_FORMATS_ADAM_CAS
+#define HAS_FORMATS_APF_APT
+#define HAS_FORMATS_ASST128_DSK
+#define HAS_FORMATS_CSW_CAS
+#define HAS_FORMATS_P6001_CAS
+#define HAS_FORMATS_ATOM_DSK
+#define HAS_FORMATS_D80_DSK
+#define HAS_FORMATS_ORIC_DSK
+#define HAS_FORMATS_NASLITE_DSK
+#define HAS_FORMATS_AP2_DSK
+#define HAS_FORMATS_TRS80_DSK
+#define HAS_FORMATS_COCO_CAS
+#define HAS_FORMATS_FDD_DSK
+#define HAS_FORMATS_2D_DSK
+#define HAS_FORMATS_UNIFLEX_DSK
+#define HAS_FORMATS_LVIV_LVT
+#define HAS_FORMATS_KC85_DSK
+#define HAS_FORMATS_JFD_DSK
+#define HAS_FORMATS_HPI_DSK
+#define HAS_FORMATS_DCP_DSK
+#define HAS_FORMATS_IMG_DSK
+#define HAS_FORMATS_APRIDISK
+#define HAS_FORMATS_SORC_DSK
+#define HAS_FORMATS_SDD_DSK
+#define HAS_FORMATS_ESQ8_DSK
+
+#endif
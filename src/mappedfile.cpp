@@ -0,0 +1,66 @@
+/***************************************************************************
+
+	mappedfile.cpp
+
+	Read-only, memory-mapped view of an image file
+
+***************************************************************************/
+
+// qfloptool headers
+#include "mappedfile.h"
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  ctor
+//-------------------------------------------------
+
+MappedFile::MappedFile(QIODevice &device)
+	: m_isMapped(false)
+{
+	// if this is a file, we open our own handle so that the mapping outlives the caller's device
+	QFileDevice *fileDevice = qobject_cast<QFileDevice *>(&device);
+	if (fileDevice && !fileDevice->fileName().isEmpty())
+	{
+		m_fileName = fileDevice->fileName();
+		m_file.setFileName(m_fileName);
+		if (m_file.open(QIODevice::ReadOnly) && m_file.size() > 0)
+		{
+			const uchar *data = m_file.map(0, m_file.size());
+			m_isMapped = data != nullptr;
+			if (m_isMapped)
+				m_bytes = std::span<const uint8_t>(data, (std::size_t)m_file.size());
+		}
+	}
+
+	// mapping is not possible (not a file, an empty file, or the platform refused); read the bytes in
+	if (!m_isMapped)
+	{
+		if (!device.isSequential())
+			device.seek(0);
+		m_fallbackBytes = device.readAll();
+		m_bytes = std::span<const uint8_t>((const uint8_t *)m_fallbackBytes.constData(), (std::size_t)m_fallbackBytes.size());
+	}
+}
+
+
+//-------------------------------------------------
+//  dtor
+//-------------------------------------------------
+
+MappedFile::~MappedFile()
+{
+}
+
+
+//-------------------------------------------------
+//  open
+//-------------------------------------------------
+
+MappedFile::ptr MappedFile::open(QIODevice &device)
+{
+	return std::make_shared<MappedFile>(device);
+}
@@ -0,0 +1,56 @@
+/***************************************************************************
+
+	mappedfile.h
+
+	Read-only, memory-mapped view of an image file
+
+***************************************************************************/
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+// Qt headers
+#include <QByteArray>
+#include <QFile>
+
+// C++ headers
+#include <memory>
+#include <span>
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> MappedFile
+
+class MappedFile
+{
+public:
+	typedef std::shared_ptr<const MappedFile> ptr;
+
+	// ctor/dtor
+	MappedFile(QIODevice &device);
+	MappedFile(const MappedFile &) = delete;
+	MappedFile(MappedFile &&) = delete;
+	~MappedFile();
+
+	// statics
+	static ptr open(QIODevice &device);
+
+	// accessors
+	const QString &fileName() const			{ return m_fileName; }
+	std::span<const uint8_t> bytes() const	{ return m_bytes; }
+	std::size_t size() const				{ return m_bytes.size(); }
+	bool isMapped() const					{ return m_isMapped; }
+
+private:
+	QString						m_fileName;
+	QFile						m_file;
+	QByteArray					m_fallbackBytes;
+	std::span<const uint8_t>	m_bytes;
+	bool						m_isMapped;
+};
+
+
+#endif // MAPPEDFILE_H
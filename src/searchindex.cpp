@@ -0,0 +1,274 @@
+/***************************************************************************
+
+	searchindex.cpp
+
+	In-memory index of every file name on an image
+
+***************************************************************************/
+
+// qfloptool headers
+#include "searchindex.h"
+
+// MAME headers
+#include "formats/fsmgr.h"
+
+// C++ headers
+#include <algorithm>
+#include <iterator>
+
+
+//**************************************************************************
+//  CONSTANTS
+//**************************************************************************
+
+// corrupt images can have directories that contain their own ancestors; these keep the
+// walk finite
+static const int s_maximumDepth = 64;
+static const int s_maximumEntryCount = 1000000;
+
+
+//**************************************************************************
+//  IMPLEMENTATION
+//**************************************************************************
+
+//-------------------------------------------------
+//  trigram
+//-------------------------------------------------
+
+static uint64_t trigram(QStringView s)
+{
+	return ((uint64_t)s[0].unicode() << 32) | ((uint64_t)s[1].unicode() << 16) | s[2].unicode();
+}
+
+
+//-------------------------------------------------
+//  globMatch
+//-------------------------------------------------
+
+static bool globMatch(QStringView name, QStringView pattern)
+{
+	// '*' matches any run of characters and '?' any single character; on a mismatch
+	// we go back to the most recent '*' and let it swallow one more character
+	qsizetype n = 0, p = 0, starP = -1, starN = 0;
+	while (n < name.size())
+	{
+		if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n]))
+		{
+			n++;
+			p++;
+		}
+		else if (p < pattern.size() && pattern[p] == '*')
+		{
+			starP = p++;
+			starN = n;
+		}
+		else if (starP >= 0)
+		{
+			p = starP + 1;
+			n = ++starN;
+		}
+		else
+		{
+			return false;
+		}
+	}
+	while (p < pattern.size() && pattern[p] == '*')
+		p++;
+	return p == pattern.size();
+}
+
+
+//-------------------------------------------------
+//  build
+//-------------------------------------------------
+
+SearchIndex::ptr SearchIndex::build(fs::filesystem_t &fileSystem, const Floptool::Image &image, const std::function<bool()> &isCancelled)
+{
+	std::shared_ptr<SearchIndex> result = std::make_shared<SearchIndex>();
+	result->m_nameOffsets.push_back(0);
+
+	// walk the whole image depth first; directories are identified by their entry index,
+	// with -1 being the root
+	std::vector<std::pair<int, int>> pendingDirectories = { { -1, 0 } };
+	while (!pendingDirectories.empty())
+	{
+		if (isCancelled())
+			return ptr();
+
+		auto [directoryIndex, depth] = pendingDirectories.back();
+		pendingDirectories.pop_back();
+
+		// directory_contents() brings the metadata along regardless; we only keep the names
+		auto [err, entries] = fileSystem.directory_contents(directoryIndex >= 0 ? result->path(directoryIndex) : std::vector<std::string>());
+		if (err)
+			continue;
+
+		for (const fs::dir_entry &entry : entries)
+		{
+			if (result->entryCount() >= s_maximumEntryCount)
+				break;
+			result->addEntry(directoryIndex, entry, image);
+			if (entry.m_type == fs::dir_entry_type::dir && depth < s_maximumDepth)
+				pendingDirectories.emplace_back(result->entryCount() - 1, depth + 1);
+		}
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  addEntry
+//-------------------------------------------------
+
+void SearchIndex::addEntry(int parentIndex, const fs::dir_entry &entry, const Floptool::Image &image)
+{
+	int entryIndex = entryCount();
+	m_nameArena.append(entry.m_name);
+	m_nameOffsets.push_back((uint32_t)m_nameArena.size());
+	m_parentIndexes.push_back(parentIndex);
+	m_isDirectory.push_back(entry.m_type == fs::dir_entry_type::dir);
+
+	QString displayName = image.convert(entry.m_name);
+	QString foldedName = displayName.toCaseFolded();
+
+	// file each distinct trigram of the name
+	std::vector<uint64_t> keys;
+	for (qsizetype i = 0; i + 3 <= foldedName.size(); i++)
+		keys.push_back(trigram(QStringView(foldedName).mid(i, 3)));
+	std::ranges::sort(keys);
+	auto [first, last] = std::ranges::unique(keys);
+	keys.erase(first, last);
+	for (uint64_t key : keys)
+		m_trigrams[key].push_back(entryIndex);
+
+	m_displayNames.push_back(std::move(displayName));
+	m_foldedNames.push_back(std::move(foldedName));
+}
+
+
+//-------------------------------------------------
+//  find
+//-------------------------------------------------
+
+std::vector<int> SearchIndex::find(const QString &query, std::size_t maxResults) const
+{
+	std::vector<int> result;
+	QString pattern = query.toCaseFolded();
+	if (pattern.isEmpty())
+		return result;
+
+	// anything with wildcards is a glob that has to match the whole name; anything else
+	// is a substring; either way, the literal runs narrow down the candidates
+	bool isGlob = pattern.contains('*') || pattern.contains('?');
+	std::vector<QStringView> literals;
+	if (isGlob)
+	{
+		qsizetype start = 0;
+		for (qsizetype i = 0; i <= pattern.size(); i++)
+		{
+			if (i == pattern.size() || pattern[i] == '*' || pattern[i] == '?')
+			{
+				if (i > start)
+					literals.push_back(QStringView(pattern).mid(start, i - start));
+				start = i + 1;
+			}
+		}
+	}
+	else
+	{
+		literals.push_back(pattern);
+	}
+
+	auto isMatch = [this, isGlob, &pattern](int entryIndex)
+	{
+		return isGlob
+			? globMatch(m_foldedNames[entryIndex], pattern)
+			: m_foldedNames[entryIndex].contains(pattern);
+	};
+
+	// the trigrams tell us what might match; short queries just scan everything
+	std::optional<std::vector<int>> candidateIndexes = candidates(literals);
+	if (candidateIndexes)
+	{
+		for (int entryIndex : *candidateIndexes)
+		{
+			if (result.size() >= maxResults)
+				break;
+			if (isMatch(entryIndex))
+				result.push_back(entryIndex);
+		}
+	}
+	else
+	{
+		for (int entryIndex = 0; entryIndex < entryCount() && result.size() < maxResults; entryIndex++)
+		{
+			if (isMatch(entryIndex))
+				result.push_back(entryIndex);
+		}
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  candidates
+//-------------------------------------------------
+
+std::optional<std::vector<int>> SearchIndex::candidates(const std::vector<QStringView> &literals) const
+{
+	// gather the entry lists of every trigram in the literals
+	static const std::vector<int> s_noEntries;
+	std::vector<const std::vector<int> *> lists;
+	for (QStringView literal : literals)
+	{
+		for (qsizetype i = 0; i + 3 <= literal.size(); i++)
+		{
+			auto iter = m_trigrams.find(trigram(literal.mid(i, 3)));
+			lists.push_back(iter != m_trigrams.end() ? &iter->second : &s_noEntries);
+		}
+	}
+	if (lists.empty())
+		return {};
+
+	// and intersect them, shortest first so that the working set only ever shrinks
+	std::ranges::sort(lists, [](const std::vector<int> *a, const std::vector<int> *b)
+	{
+		return a->size() < b->size();
+	});
+	std::vector<int> result = *lists[0];
+	std::vector<int> intersection;
+	for (std::size_t i = 1; i < lists.size() && !result.empty(); i++)
+	{
+		intersection.clear();
+		std::ranges::set_intersection(result, *lists[i], std::back_inserter(intersection));
+		result.swap(intersection);
+	}
+	return result;
+}
+
+
+//-------------------------------------------------
+//  path
+//-------------------------------------------------
+
+std::vector<std::string> SearchIndex::path(int entryIndex) const
+{
+	std::vector<std::string> result;
+	for (int i = entryIndex; i >= 0; i = m_parentIndexes[i])
+		result.emplace_back(m_nameArena, m_nameOffsets[i], m_nameOffsets[i + 1] - m_nameOffsets[i]);
+	std::ranges::reverse(result);
+	return result;
+}
+
+
+//-------------------------------------------------
+//  displayPath
+//-------------------------------------------------
+
+QString SearchIndex::displayPath(int entryIndex) const
+{
+	QString result = m_displayNames[entryIndex];
+	for (int i = m_parentIndexes[entryIndex]; i >= 0; i = m_parentIndexes[i])
+		result = m_displayNames[i] + '/' + result;
+	return result;
+}
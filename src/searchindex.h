@@ -0,0 +1,64 @@
+/***************************************************************************
+
+	searchindex.h
+
+	In-memory index of every file name on an image
+
+***************************************************************************/
+
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+// qfloptool headers
+#include "floptool.h"
+
+// Qt headers
+#include <QString>
+
+// C++ headers
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+//**************************************************************************
+//  TYPE DECLARATIONS
+//**************************************************************************
+
+// ======================> SearchIndex
+
+class SearchIndex
+{
+public:
+	typedef std::shared_ptr<const SearchIndex> ptr;
+
+	// statics
+	static ptr build(fs::filesystem_t &fileSystem, const Floptool::Image &image, const std::function<bool()> &isCancelled);
+
+	// accessors
+	int entryCount() const					{ return (int)m_parentIndexes.size(); }
+	bool isDirectory(int entryIndex) const	{ return m_isDirectory[entryIndex]; }
+
+	// methods
+	std::vector<int> find(const QString &query, std::size_t maxResults) const;
+	std::vector<std::string> path(int entryIndex) const;
+	QString displayPath(int entryIndex) const;
+
+private:
+	std::string										m_nameArena;
+	std::vector<uint32_t>							m_nameOffsets;		// one more than there are entries
+	std::vector<QString>							m_displayNames;
+	std::vector<QString>							m_foldedNames;
+	std::vector<int>								m_parentIndexes;	// -1 for the root directory
+	std::vector<bool>								m_isDirectory;
+	std::unordered_map<uint64_t, std::vector<int>>	m_trigrams;			// entries containing each trigram, in order
+
+	void addEntry(int parentIndex, const fs::dir_entry &entry, const Floptool::Image &image);
+	std::optional<std::vector<int>> candidates(const std::vector<QStringView> &literals) const;
+};
+
+
+#endif // SEARCHINDEX_H